@@ -3,16 +3,36 @@
 
 #include <QString>
 #include <QMap>
+#include <QList>
+#include <QStringList>
 
 struct BreakPoint
 {
+    BreakPoint() : id( 0 ), fromLine( 0 ), toLine( 0 ), fromColumn( 0 ), toColumn( 0 ), hitCount( 0 ) {}
+
     QString command;
     int id;
     QString file;
     int fromLine, toLine, fromColumn, toColumn;
+    // Expressions printed on hit by a logpoint, which resumes the execution
+    QStringList log;
+    // A conditional breakpoint stops only when the condition holds,
+    // from the hitCount-th time on
+    QString condition;
+    int hitCount;
 };
 
+inline bool operator==( const BreakPoint &a, const BreakPoint &b )
+{
+    return a.id == b.id && a.file == b.file
+        && a.fromLine == b.fromLine && a.toLine == b.toLine
+        && a.fromColumn == b.fromColumn && a.toColumn == b.toColumn
+        && a.log == b.log
+        && a.condition == b.condition && a.hitCount == b.hitCount;
+}
+
 typedef QMap<int,BreakPoint> BreakPoints;
+typedef QList<BreakPoint> BreakPointList;
 
 
 #endif
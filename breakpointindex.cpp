@@ -0,0 +1,37 @@
+#include "breakpointindex.h"
+#include <QFileInfo>
+#include <QStringList>
+
+BreakpointIndex::BreakpointIndex( QObject *parent_p ) : QObject( parent_p )
+{
+}
+
+// ocamldebug reports the files as found in the debug information,
+// so the file name is the only reliable part to compare with an opened source
+QString BreakpointIndex::key( const QString &file )
+{
+    return QFileInfo( file ).fileName();
+}
+
+void BreakpointIndex::setBreakpoints( const BreakPoints &breakpoints )
+{
+    QHash<QString,BreakPointList> files;
+    for ( BreakPoints::const_iterator itBreakpoint = breakpoints.begin(); itBreakpoint != breakpoints.end(); ++itBreakpoint )
+        files[ key( itBreakpoint->file ) ].append( itBreakpoint.value() );
+
+    QStringList changed;
+    for ( QHash<QString,BreakPointList>::const_iterator itFile = files.begin(); itFile != files.end(); ++itFile )
+    {
+        if ( _files.value( itFile.key() ) != itFile.value() )
+            changed << itFile.key();
+    }
+    for ( QHash<QString,BreakPointList>::const_iterator itFile = _files.begin(); itFile != _files.end(); ++itFile )
+    {
+        if ( !files.contains( itFile.key() ) )
+            changed << itFile.key();
+    }
+
+    _files = files;
+    for ( QStringList::const_iterator itKey = changed.begin(); itKey != changed.end(); ++itKey )
+        emit breakpointsChanged( *itKey );
+}
@@ -0,0 +1,28 @@
+#ifndef BREAKPOINTINDEX_H
+#define BREAKPOINTINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include "breakpoint.h"
+
+// Breakpoints grouped by source file.
+// Only the files whose breakpoints changed are notified.
+class BreakpointIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    BreakpointIndex( QObject *parent_p );
+    static QString key( const QString &file );
+    BreakPointList breakpoints( const QString &key ) const { return _files.value( key ); }
+    void setBreakpoints( const BreakPoints & );
+
+signals:
+    void breakpointsChanged( const QString &key );
+
+private:
+    QHash<QString,BreakPointList> _files;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "breakpointmodel.h"
+#include <QColor>
+
+BreakpointModel::BreakpointModel( QObject *parent_p ) : QAbstractTableModel( parent_p ),
+    _delete_icon( ":/images/delete.png" )
+{
+}
+
+int BreakpointModel::rowCount( const QModelIndex &parent ) const
+{
+    if ( parent.isValid() )
+        return 0;
+    return _breakpoints.count();
+}
+
+int BreakpointModel::columnCount( const QModelIndex &parent ) const
+{
+    if ( parent.isValid() )
+        return 0;
+    return COLUMN_COUNT;
+}
+
+Qt::ItemFlags BreakpointModel::flags( const QModelIndex & ) const
+{
+    return Qt::ItemIsEnabled;
+}
+
+QVariant BreakpointModel::headerData( int section, Qt::Orientation orientation, int role ) const
+{
+    if ( orientation != Qt::Horizontal || role != Qt::DisplayRole )
+        return QVariant();
+    switch ( section )
+    {
+        case DELETE_COLUMN: return tr( "Del" );
+        case ID_COLUMN:     return tr( "Id" );
+        case FROM_COLUMN:   return tr( "From" );
+        case TO_COLUMN:     return tr( "To" );
+        case FILE_COLUMN:   return tr( "File" );
+        case LOG_COLUMN:    return tr( "Log" );
+        case CONDITION_COLUMN: return tr( "Condition" );
+    }
+    return QVariant();
+}
+
+QVariant BreakpointModel::data( const QModelIndex &index, int role ) const
+{
+    if ( !index.isValid() || index.row() >= _breakpoints.count() )
+        return QVariant();
+
+    const BreakPoint &breakpoint = _breakpoints.at( index.row() );
+    switch ( role )
+    {
+        case Qt::DisplayRole:
+            switch ( index.column() )
+            {
+                case ID_COLUMN:   return breakpoint.id;
+                case FROM_COLUMN: return QString::number( breakpoint.fromLine ) + ":" + QString::number( breakpoint.fromColumn );
+                case TO_COLUMN:   return QString::number( breakpoint.toLine ) + ":" + QString::number( breakpoint.toColumn );
+                case FILE_COLUMN: return breakpoint.file.simplified();
+                case LOG_COLUMN:  return breakpoint.log.join( " " );
+                case CONDITION_COLUMN:
+                    if ( breakpoint.hitCount > 1 )
+                        return tr( "%1 (from hit %2)" ).arg( breakpoint.condition ).arg( breakpoint.hitCount ).trimmed();
+                    return breakpoint.condition;
+            }
+            break;
+        case Qt::DecorationRole:
+            if ( index.column() == DELETE_COLUMN )
+                return _delete_icon;
+            break;
+        case Qt::ToolTipRole:
+            if ( index.column() == DELETE_COLUMN )
+                return tr( "Click to delete this breakpoint." );
+            break;
+        case Qt::BackgroundRole:
+            if ( index.column() != DELETE_COLUMN && _hits.contains( breakpoint.id ) )
+                return QColor( Qt::yellow );
+            break;
+    }
+    return QVariant();
+}
+
+int BreakpointModel::breakpointId( const QModelIndex &index ) const
+{
+    if ( !index.isValid() || index.row() >= _breakpoints.count() )
+        return -1;
+    return _breakpoints.at( index.row() ).id;
+}
+
+BreakPoint BreakpointModel::breakpoint( const QModelIndex &index ) const
+{
+    if ( !index.isValid() || index.row() >= _breakpoints.count() )
+        return BreakPoint();
+    return _breakpoints.at( index.row() );
+}
+
+int BreakpointModel::row( int id ) const
+{
+    int low = 0, high = _breakpoints.count();
+    while ( low < high )
+    {
+        int mid = ( low + high ) / 2;
+        if ( _breakpoints.at( mid ).id < id )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if ( low < _breakpoints.count() && _breakpoints.at( low ).id == id )
+        return low;
+    return -1;
+}
+
+// Merges the new list (ordered by id) into the rows
+void BreakpointModel::setBreakpoints( const BreakPoints &breakpoints )
+{
+    int r = 0;
+    BreakPoints::const_iterator itBreakpoint = breakpoints.begin();
+    while ( r < _breakpoints.count() || itBreakpoint != breakpoints.end() )
+    {
+        if ( itBreakpoint == breakpoints.end() || ( r < _breakpoints.count() && _breakpoints.at( r ).id < itBreakpoint.key() ) )
+        {
+            int last = r;
+            while ( last + 1 < _breakpoints.count() && ( itBreakpoint == breakpoints.end() || _breakpoints.at( last + 1 ).id < itBreakpoint.key() ) )
+                last++;
+            beginRemoveRows( QModelIndex(), r, last );
+            for ( int i = r; i <= last; i++ )
+            {
+                _hits.remove( _breakpoints.at( r ).id );
+                _breakpoints.removeAt( r );
+            }
+            endRemoveRows();
+        }
+        else if ( r >= _breakpoints.count() || _breakpoints.at( r ).id > itBreakpoint.key() )
+        {
+            beginInsertRows( QModelIndex(), r, r );
+            _breakpoints.insert( r, itBreakpoint.value() );
+            endInsertRows();
+            ++itBreakpoint;
+            r++;
+        }
+        else
+        {
+            if ( !( _breakpoints.at( r ) == itBreakpoint.value() ) )
+            {
+                _breakpoints[ r ] = itBreakpoint.value();
+                emit dataChanged( index( r, 0 ), index( r, COLUMN_COUNT - 1 ) );
+            }
+            else
+                _breakpoints[ r ].command = itBreakpoint->command;
+            ++itBreakpoint;
+            r++;
+        }
+    }
+}
+
+void BreakpointModel::setHits( const QList<int> &hits )
+{
+    QSet<int> new_hits = hits.toSet();
+    QSet<int> changed = ( new_hits - _hits ) + ( _hits - new_hits );
+    _hits = new_hits;
+    foreach ( int id, changed )
+    {
+        int r = row( id );
+        if ( r >= 0 )
+            emit dataChanged( index( r, ID_COLUMN ), index( r, COLUMN_COUNT - 1 ) );
+    }
+}
+
+void BreakpointModel::clear()
+{
+    beginResetModel();
+    _breakpoints.clear();
+    _hits.clear();
+    endResetModel();
+}
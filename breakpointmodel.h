@@ -0,0 +1,49 @@
+#ifndef BREAKPOINTMODEL_H
+#define BREAKPOINTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QSet>
+#include <QIcon>
+#include "breakpoint.h"
+
+// Table of the breakpoints ordered by id.
+// Only the rows which changed are notified to the views.
+class BreakpointModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        DELETE_COLUMN,
+        ID_COLUMN,
+        FROM_COLUMN,
+        TO_COLUMN,
+        FILE_COLUMN,
+        LOG_COLUMN,
+        CONDITION_COLUMN,
+        COLUMN_COUNT
+    };
+    BreakpointModel( QObject *parent_p );
+
+    int rowCount( const QModelIndex &parent = QModelIndex() ) const;
+    int columnCount( const QModelIndex &parent = QModelIndex() ) const;
+    QVariant data( const QModelIndex &index, int role = Qt::DisplayRole ) const;
+    QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const;
+    Qt::ItemFlags flags( const QModelIndex &index ) const;
+
+    int breakpointId( const QModelIndex &index ) const;
+    BreakPoint breakpoint( const QModelIndex &index ) const;
+    void setBreakpoints( const BreakPoints & );
+    void setHits( const QList<int> & );
+    void clear();
+
+private:
+    int row( int id ) const;
+    QList<BreakPoint> _breakpoints;
+    QSet<int> _hits;
+    QIcon _delete_icon;
+};
+
+#endif
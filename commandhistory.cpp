@@ -0,0 +1,139 @@
+#include "commandhistory.h"
+
+CommandHistory::CommandHistory( int capacity ) :
+    _capacity( qMax( 1, capacity ) )
+{
+}
+
+void CommandHistory::setCapacity( int capacity )
+{
+    _capacity = qMax( 1, capacity );
+    while ( count() > _capacity )
+        remove( next( -1 ) );
+    compact();
+}
+
+bool CommandHistory::add( const QString &command )
+{
+    if ( command.isEmpty() )
+        return false;
+    QHash<QString,int>::const_iterator itIndex = _index.find( command );
+    if ( itIndex != _index.end() )
+    {
+        if ( itIndex.value() == _entries.count() - 1 )
+            return false;
+        remove( itIndex.value() );
+    }
+    while ( count() >= _capacity )
+        remove( next( -1 ) );
+
+    _index.insert( command, _entries.count() );
+    _sorted.insert( command, _entries.count() );
+    _entries.append( command );
+    return compact();
+}
+
+void CommandHistory::remove( int position )
+{
+    if ( position < 0 )
+        return;
+    _index.remove( _entries.at( position ) );
+    _sorted.remove( _entries.at( position ) );
+    _entries[ position ].clear();
+}
+
+// Removed entries are empty strings
+bool CommandHistory::compact()
+{
+    if ( _entries.count() <= 2 * count() + 16 )
+        return false;
+
+    QVector<QString> entries;
+    entries.reserve( count() );
+    for ( QVector<QString>::const_iterator itEntry = _entries.begin(); itEntry != _entries.end(); ++itEntry )
+    {
+        if ( !itEntry->isEmpty() )
+        {
+            _index[ *itEntry ] = entries.count();
+            _sorted[ *itEntry ] = entries.count();
+            entries.append( *itEntry );
+        }
+    }
+    _entries = entries;
+    return true;
+}
+
+QString CommandHistory::last() const
+{
+    int position = previous( end() );
+    if ( position < 0 )
+        return QString();
+    return _entries.at( position );
+}
+
+int CommandHistory::previous( int position ) const
+{
+    for ( position--; position >= 0; position-- )
+    {
+        if ( !_entries.at( position ).isEmpty() )
+            return position;
+    }
+    return -1;
+}
+
+int CommandHistory::next( int position ) const
+{
+    for ( position++; position < _entries.count(); position++ )
+    {
+        if ( !_entries.at( position ).isEmpty() )
+            return position;
+    }
+    return -1;
+}
+
+int CommandHistory::searchBackward( const QString &text, int position ) const
+{
+    for ( position = previous( position ); position >= 0; position = previous( position ) )
+    {
+        if ( _entries.at( position ).contains( text ) )
+            return position;
+    }
+    return -1;
+}
+
+QString CommandHistory::complete( const QString &prefix ) const
+{
+    QString result;
+    int newest = -1;
+    for ( QMap<QString,int>::const_iterator itEntry = _sorted.lowerBound( prefix );
+            itEntry != _sorted.end() && itEntry.key().startsWith( prefix );
+            ++itEntry )
+    {
+        if ( itEntry.value() > newest )
+        {
+            newest = itEntry.value();
+            result = itEntry.key();
+        }
+    }
+    return result;
+}
+
+QStringList CommandHistory::toStringList() const
+{
+    QStringList result;
+    for ( QVector<QString>::const_iterator itEntry = _entries.begin(); itEntry != _entries.end(); ++itEntry )
+    {
+        if ( !itEntry->isEmpty() )
+            result << *itEntry;
+    }
+    return result;
+}
+
+void CommandHistory::fromStringList( const QStringList &commands )
+{
+    _entries.clear();
+    _index.clear();
+    _sorted.clear();
+    for ( QStringList::const_iterator itCommand = commands.begin(); itCommand != commands.end(); ++itCommand )
+        add( *itCommand );
+}
@@ -0,0 +1,50 @@
+#ifndef COMMANDHISTORY_H
+#define COMMANDHISTORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+// Bounded history of the console commands, oldest first.
+// A command entered again is moved to the end; the hash index makes this O(1)
+// and the removed entries are only compacted once they outnumber the live ones.
+// Positions are stable until add() returns true.
+class CommandHistory
+{
+public:
+    CommandHistory( int capacity = 1000 );
+    void setCapacity( int capacity );
+    int capacity() const { return _capacity; }
+    bool add( const QString &command );
+    bool isEmpty() const { return _index.isEmpty(); }
+    int count() const { return _index.count(); }
+    QString last() const;
+
+    // Navigation: end() is the position after the newest command,
+    // previous() and next() return -1 if there is no such command
+    int end() const { return _entries.count(); }
+    int previous( int position ) const;
+    int next( int position ) const;
+    const QString & at( int position ) const { return _entries.at( position ); }
+
+    // Newest command before position containing text, -1 if none
+    int searchBackward( const QString &text, int position ) const;
+    // Newest command starting with prefix
+    QString complete( const QString &prefix ) const;
+
+    QStringList toStringList() const;
+    void fromStringList( const QStringList & );
+
+private:
+    void remove( int position );
+    bool compact();
+
+    int _capacity;
+    QVector<QString> _entries;
+    QHash<QString,int> _index;
+    QMap<QString,int> _sorted;
+};
+
+#endif
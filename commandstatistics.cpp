@@ -0,0 +1,149 @@
+#include "commandstatistics.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+
+static const int bucket_count = 12;
+
+CommandKindStatistics::CommandKindStatistics() :
+    count( 0 ),
+    queue_total( 0 ),
+    queue_max( 0 ),
+    response_total( 0 ),
+    response_min( 0 ),
+    response_max( 0 ),
+    processing_total( 0 ),
+    processing_max( 0 ),
+    histogram( bucket_count, 0 )
+{
+}
+
+QString CommandStatistics::kind( const QString &command )
+{
+    static QMap<QString,QString> aliases;
+    if ( aliases.isEmpty() )
+    {
+        aliases["s"] = "step";
+        aliases["n"] = "next";
+        aliases["bs"] = "backstep";
+        aliases["prev"] = "previous";
+        aliases["r"] = "run";
+        aliases["rev"] = "reverse";
+        aliases["p"] = "print";
+        aliases["bt"] = "backtrace";
+        aliases["b"] = "break";
+        aliases["d"] = "delete";
+        aliases["del"] = "delete";
+        aliases["fr"] = "frame";
+    }
+    QString k = command.section( ' ', 0, 0, QString::SectionSkipEmpty );
+    return aliases.value( k, k );
+}
+
+int CommandStatistics::bucketCount()
+{
+    return bucket_count;
+}
+
+// Upper limit of a histogram bucket: 0.25ms, 0.5ms, 1ms ... the last one is unbounded
+qint64 CommandStatistics::bucketLimit( int bucket )
+{
+    if ( bucket >= bucket_count - 1 )
+        return -1;
+    return qint64( 250000 ) << bucket;
+}
+
+QString CommandStatistics::bucketName( int bucket )
+{
+    if ( bucket >= bucket_count - 1 )
+        return QString( ">%1ms" ).arg( bucketLimit( bucket - 1 ) / 1000000.0 );
+    return QString( "<%1ms" ).arg( bucketLimit( bucket ) / 1000000.0 );
+}
+
+void CommandStatistics::append( const DebuggerCommand &command )
+{
+    if ( !command.isTimed() )
+        return;
+    QString k = kind( command.command() );
+    if ( k.isEmpty() )
+        return;
+
+    CommandKindStatistics &statistics = _kinds[ k ];
+    qint64 response = command.responseTime();
+    if ( statistics.count == 0 || response < statistics.response_min )
+        statistics.response_min = response;
+    statistics.count++;
+    statistics.queue_total += command.queueTime();
+    statistics.queue_max = qMax( statistics.queue_max, command.queueTime() );
+    statistics.response_total += response;
+    statistics.response_max = qMax( statistics.response_max, response );
+    statistics.processing_total += command.processingTime();
+    statistics.processing_max = qMax( statistics.processing_max, command.processingTime() );
+
+    int bucket = 0;
+    while ( bucket < bucket_count - 1 && response >= bucketLimit( bucket ) )
+        bucket++;
+    statistics.histogram[ bucket ]++;
+}
+
+QString CommandStatistics::toCsv() const
+{
+    QString csv;
+    QTextStream out( &csv );
+    double ms = 1000000.0;
+    out << "command,count,queue_mean_ms,queue_max_ms,response_mean_ms,response_min_ms,response_max_ms,processing_mean_ms,processing_max_ms";
+    for ( int bucket = 0; bucket < bucket_count; bucket++ )
+        out << ',' << bucketName( bucket );
+    out << '\n';
+    for ( QMap<QString,CommandKindStatistics>::const_iterator itKind = _kinds.begin(); itKind != _kinds.end(); ++itKind )
+    {
+        out << itKind.key()
+            << ',' << itKind->count
+            << ',' << itKind->queue_total / ms / itKind->count
+            << ',' << itKind->queue_max / ms
+            << ',' << itKind->response_total / ms / itKind->count
+            << ',' << itKind->response_min / ms
+            << ',' << itKind->response_max / ms
+            << ',' << itKind->processing_total / ms / itKind->count
+            << ',' << itKind->processing_max / ms;
+        for ( int bucket = 0; bucket < bucket_count; bucket++ )
+            out << ',' << itKind->histogram.at( bucket );
+        out << '\n';
+    }
+    out.flush();
+    return csv;
+}
+
+QByteArray CommandStatistics::toJson() const
+{
+    double ms = 1000000.0;
+    QJsonArray buckets;
+    for ( int bucket = 0; bucket < bucket_count; bucket++ )
+        buckets.append( bucketName( bucket ) );
+
+    QJsonObject commands;
+    for ( QMap<QString,CommandKindStatistics>::const_iterator itKind = _kinds.begin(); itKind != _kinds.end(); ++itKind )
+    {
+        QJsonObject command;
+        command["count"] = itKind->count;
+        command["queue_mean_ms"] = itKind->queue_total / ms / itKind->count;
+        command["queue_max_ms"] = itKind->queue_max / ms;
+        command["response_mean_ms"] = itKind->response_total / ms / itKind->count;
+        command["response_min_ms"] = itKind->response_min / ms;
+        command["response_max_ms"] = itKind->response_max / ms;
+        command["processing_mean_ms"] = itKind->processing_total / ms / itKind->count;
+        command["processing_max_ms"] = itKind->processing_max / ms;
+        QJsonArray histogram;
+        for ( int bucket = 0; bucket < bucket_count; bucket++ )
+            histogram.append( itKind->histogram.at( bucket ) );
+        command["histogram"] = histogram;
+        commands[ itKind.key() ] = command;
+    }
+
+    QJsonObject statistics;
+    statistics["buckets"] = buckets;
+    statistics["commands"] = commands;
+    return QJsonDocument( statistics ).toJson();
+}
@@ -0,0 +1,39 @@
+#ifndef COMMANDSTATISTICS_H
+#define COMMANDSTATISTICS_H
+
+#include <QString>
+#include <QMap>
+#include <QVector>
+#include <QByteArray>
+#include "debuggercommand.h"
+
+struct CommandKindStatistics
+{
+    CommandKindStatistics();
+    int count;
+    qint64 queue_total, queue_max;
+    qint64 response_total, response_min, response_max;
+    qint64 processing_total, processing_max;
+    QVector<int> histogram; // response times, see CommandStatistics::bucketLimit
+};
+
+class CommandStatistics
+{
+public:
+    static QString kind( const QString &command );
+    static int bucketCount();
+    static qint64 bucketLimit( int bucket );
+    static QString bucketName( int bucket );
+
+    void append( const DebuggerCommand & );
+    void clear() { _kinds.clear(); }
+    bool isEmpty() const { return _kinds.isEmpty(); }
+    const QMap<QString,CommandKindStatistics> & kinds() const { return _kinds; }
+    QString toCsv() const;
+    QByteArray toJson() const;
+
+private:
+    QMap<QString,CommandKindStatistics> _kinds;
+};
+
+#endif
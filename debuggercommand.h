@@ -15,7 +15,14 @@ class DebuggerCommand
         };
         DebuggerCommand( const QString &command, Option o ) :
             _option( o ),
-            _command( command )
+            _command( command ),
+            _enqueued( -1 ),
+            _written( -1 ),
+            _completed( -1 ),
+            _processing( 0 ),
+            _processing_before_completion( 0 ),
+            _pipelined( false ),
+            _sequence( 0 )
         {
         }
 
@@ -24,10 +31,35 @@ class DebuggerCommand
         const QString &result() const { return _result; }
         void appendResult( const QString &s ) { _result += s; }
         void setOption( Option o ) { _option = o ; }
+        // Pipelined commands are written without waiting for the prompt of the previous pipelined command
+        void setPipelined( bool p ) { _pipelined = p ; }
+        bool pipelined() const { return _pipelined ; }
+        // Internal commands are numbered by the client of the engine issuing them
+        // for itself: their answer is only given back through commandCompleted()
+        void setSequence( int s ) { _sequence = s ; }
+        int sequence() const { return _sequence ; }
+        bool internal() const { return _sequence > 0 ; }
+
+        // Timestamps in nanoseconds of the engine clock
+        void setEnqueued( qint64 t ) { _enqueued = t ; }
+        void setWritten( qint64 t ) { _written = t ; }
+        void setCompleted( qint64 t ) { _completed = t ; _processing_before_completion = _processing ; }
+        void addProcessingTime( qint64 t ) { _processing += t ; }
+        bool isTimed() const { return _enqueued >= 0 && _written >= 0 && _completed >= 0 ; }
+        // Time spent in the queue before being written to ocamldebug
+        qint64 queueTime() const { return _written - _enqueued ; }
+        // Time taken by ocamldebug to answer, without the processing of the partial answers
+        qint64 responseTime() const { return _completed - _written - _processing_before_completion ; }
+        // Time spent parsing the answer and in the connected views
+        qint64 processingTime() const { return _processing ; }
     private:
         Option _option;
         QString _command;
         QString _result;
+        qint64 _enqueued, _written, _completed;
+        qint64 _processing, _processing_before_completion;
+        bool _pipelined;
+        int _sequence;
 };
 
 #endif
@@ -0,0 +1,114 @@
+#include "debuggerreply.h"
+#include <QRegExp>
+#include <QStringList>
+
+bool DebuggerReply::parseStackFrame( const QString &line, StackFrame &frame )
+{
+    static QRegExp stackRx( "^#([0-9]*)  *Pc *: *([0-9]+) *([^ ]+)  *char  *([0-9]+) *\\n?$" );
+    if ( !stackRx.exactMatch( line ) )
+        return false;
+
+    bool ok;
+    frame.frame = stackRx.cap(1).toInt( &ok );
+    if ( !ok )
+        return false;
+    frame.pc = stackRx.cap(2).toInt( &ok );
+    if ( !ok )
+        return false;
+    frame.module = stackRx.cap(3);
+    frame.position = stackRx.cap(4).toInt( &ok );
+    return ok;
+}
+
+StackFrames DebuggerReply::parseBacktrace( const QString &result )
+{
+    StackFrames frames;
+    QStringList results = result.split( '\n' );
+    for ( QStringList::const_iterator itResult = results.begin() ; itResult != results.end() ; ++itResult )
+    {
+        StackFrame frame;
+        if ( parseStackFrame( *itResult, frame ) )
+            frames.append( frame );
+    }
+    return frames;
+}
+
+int DebuggerReply::parseCurrentFrame( const QString &result )
+{
+    int current_frame = -1;
+    QStringList results = result.split( '\n' );
+    for ( QStringList::const_iterator itResult = results.begin() ; itResult != results.end() ; ++itResult )
+    {
+        StackFrame frame;
+        if ( parseStackFrame( *itResult, frame ) )
+            current_frame = frame.frame;
+    }
+    return current_frame;
+}
+
+bool DebuggerReply::parseValue( const QString &result, QString &type, QString &value )
+{
+    static QRegExp variableRx( "^[^:]* *: ([^=]*[^= ]) *= *([^ ].*)$" );
+    if ( !variableRx.exactMatch( result ) )
+        return false;
+
+    type = variableRx.cap(1).trimmed();
+    value = variableRx.cap(2).trimmed();
+    return true;
+}
+
+// Answer of ocamldebug to a command it could not execute, e.g. the print of
+// an identifier out of scope
+bool DebuggerReply::isError( const QString &result )
+{
+    static QRegExp errorRx( "^(No such frame\\.|Syntax error\\.|Unknown command\\.|Ambiguous command\\.|Unbound [a-z]+ |Cannot )" );
+    return errorRx.indexIn( result.trimmed() ) == 0;
+}
+
+// ocamldebug prints only simple expressions: the comparison of a condition
+// 'expression <op> literal' is evaluated on the printed value.
+// A condition without operator is a boolean expression.
+static QRegExp conditionRx( "^\\s*(.*[^<>=!\\s])\\s*(<=|>=|<>|!=|==|=|<|>)\\s*(.*\\S)\\s*$" );
+
+QString DebuggerReply::conditionExpression( const QString &condition )
+{
+    QRegExp rx( conditionRx );
+    if ( rx.exactMatch( condition ) )
+        return rx.cap(1);
+    return condition.trimmed();
+}
+
+// A result which cannot be parsed holds, so that the stop is reported
+bool DebuggerReply::evaluateCondition( const QString &condition, const QString &result )
+{
+    QString type, value;
+    if ( !parseValue( result.trimmed(), type, value ) )
+        return true;
+
+    QRegExp rx( conditionRx );
+    if ( !rx.exactMatch( condition ) )
+        return value == "true";
+
+    QString op = rx.cap(2);
+    QString operand = rx.cap(3);
+    bool value_ok, operand_ok;
+    double value_number = value.toDouble( &value_ok );
+    double operand_number = operand.toDouble( &operand_ok );
+    int compare;
+    if ( value_ok && operand_ok )
+        compare = value_number < operand_number ? -1 : ( value_number > operand_number ? 1 : 0 );
+    else
+        compare = QString::compare( value, operand );
+
+    if ( op == "=" || op == "==" )
+        return compare == 0;
+    if ( op == "<>" || op == "!=" )
+        return compare != 0;
+    if ( op == "<" )
+        return compare < 0;
+    if ( op == "<=" )
+        return compare <= 0;
+    if ( op == ">" )
+        return compare > 0;
+    return compare >= 0;
+}
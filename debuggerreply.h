@@ -0,0 +1,28 @@
+#ifndef DEBUGGER_REPLY_H
+#define DEBUGGER_REPLY_H
+#include <QString>
+#include <QList>
+
+struct StackFrame
+{
+    int frame;
+    int pc;
+    QString module;
+    int position;
+};
+
+typedef QList<StackFrame> StackFrames;
+
+class DebuggerReply
+{
+    public:
+        static bool parseStackFrame( const QString &line, StackFrame &frame );
+        static StackFrames parseBacktrace( const QString &result );
+        static int parseCurrentFrame( const QString &result );
+        static bool parseValue( const QString &result, QString &type, QString &value );
+        static bool isError( const QString &result );
+        static QString conditionExpression( const QString &condition );
+        static bool evaluateCondition( const QString &condition, const QString &result );
+};
+
+#endif
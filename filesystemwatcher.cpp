@@ -1,53 +1,14 @@
 #include "filesystemwatcher.h"
-#include <QFile>
-#include <QDir>
+#include "filewatchservice.h"
 #include <QFileInfo>
 
-FileSystemWatcher::FileSystemWatcher ( const QString& file  ): QFileSystemWatcher ( )
+FileSystemWatcher::FileSystemWatcher ( const QString& file  ): QObject ( )
 {
-  connect(this,SIGNAL( fileChanged ( const QString & )),
-      this,SLOT( fileChangedSlot ( const QString & )));
-  connect(this,SIGNAL( directoryChanged ( const QString & )),
-      this,SLOT( directoryChangedSlot ( const QString & )));
-  _file=file;
-  watchFile(file);
-}
-
-void FileSystemWatcher::watchFile(const QString &file)
-{
-  if (!files().isEmpty())
-    removePaths(files());
-  if (!directories().isEmpty())
-    removePaths(directories());
-  QFileInfo fileInfo(file);
-  if (fileInfo.exists())
-    addPath(file);
-  QString filePath=fileInfo.absoluteDir().path();
-  QFileInfo filePathInfo(filePath);
-  if (filePathInfo.exists())
-    addPath(filePath);
-}
-
-void FileSystemWatcher::fileChangedSlot ( const QString & )
-{
-  QFileInfo fileInfo(_file);
-  if ( fileInfo.exists() )
-    emit fileChanged();
-}
-
-void FileSystemWatcher::directoryChangedSlot ( const QString & )
-{
-  if (!files().contains(_file))
-  {
-    QFileInfo fileInfo(_file);
-    if ( fileInfo.exists() )
-    {
-      addPath(_file);
-      emit fileChanged();
-    }
-  }
+  _file=QFileInfo(file).absoluteFilePath();
+  FileWatchService::instance()->subscribe(this,_file);
 }
 
 FileSystemWatcher::~FileSystemWatcher()
 {
+  FileWatchService::instance()->unsubscribe(this,_file);
 }
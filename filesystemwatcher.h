@@ -1,9 +1,12 @@
 #ifndef FILE_SYSTEM_WATCHER_H
 #define FILE_SYSTEM_WATCHER_H
-#include <QFileSystemWatcher>
+#include <QObject>
 #include <QString>
 
-class FileSystemWatcher : public QFileSystemWatcher
+class FileWatchService;
+
+// Subscription to the changes of one file through the shared FileWatchService
+class FileSystemWatcher : public QObject
 {
   Q_OBJECT
 
@@ -13,12 +16,10 @@ class FileSystemWatcher : public QFileSystemWatcher
     virtual ~FileSystemWatcher();
 
   private:
-    void watchFile(const QString &);
+    friend class FileWatchService;
+    void notifyChanged() { emit fileChanged(); }
     QString _file;
 
-  private slots:
-    void directoryChangedSlot ( const QString & );
-    void fileChangedSlot ( const QString & );
   signals:
     void fileChanged();
 };
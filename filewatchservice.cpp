@@ -0,0 +1,89 @@
+#include "filewatchservice.h"
+#include "filesystemwatcher.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+
+FileWatchService *FileWatchService::instance()
+{
+    static FileWatchService service;
+    return &service;
+}
+
+FileWatchService::FileWatchService() : QObject()
+{
+    connect( &_watcher, SIGNAL( fileChanged( const QString & ) ), this, SLOT( fileChangedSlot( const QString & ) ) );
+    connect( &_watcher, SIGNAL( directoryChanged( const QString & ) ), this, SLOT( directoryChangedSlot( const QString & ) ) );
+}
+
+QString FileWatchService::directory( const QString &file )
+{
+    return QFileInfo( file ).absoluteDir().path();
+}
+
+void FileWatchService::addPath( const QString &path )
+{
+    if ( QFileInfo( path ).exists() && !_watcher.files().contains( path ) && !_watcher.directories().contains( path ) )
+        _watcher.addPath( path );
+}
+
+void FileWatchService::subscribe( FileSystemWatcher *subscriber_p, const QString &file )
+{
+    if ( !_subscribers.contains( file ) )
+    {
+        addPath( file );
+        QString dir = directory( file );
+        if ( _directory_references[ dir ]++ == 0 )
+            addPath( dir );
+        _directory_files.insert( dir, file );
+    }
+    _subscribers.insert( file, subscriber_p );
+}
+
+void FileWatchService::unsubscribe( FileSystemWatcher *subscriber_p, const QString &file )
+{
+    _subscribers.remove( file, subscriber_p );
+    if ( _subscribers.contains( file ) )
+        return;
+
+    if ( _watcher.files().contains( file ) )
+        _watcher.removePath( file );
+    QString dir = directory( file );
+    _directory_files.remove( dir, file );
+    if ( --_directory_references[ dir ] <= 0 )
+    {
+        _directory_references.remove( dir );
+        if ( _watcher.directories().contains( dir ) )
+            _watcher.removePath( dir );
+    }
+}
+
+void FileWatchService::notify( const QString &file )
+{
+    QList<FileSystemWatcher*> subscribers = _subscribers.values( file );
+    for ( QList<FileSystemWatcher*>::const_iterator itSubscriber = subscribers.begin(); itSubscriber != subscribers.end(); ++itSubscriber )
+        (*itSubscriber)->notifyChanged();
+}
+
+void FileWatchService::fileChangedSlot( const QString &file )
+{
+    if ( !QFileInfo( file ).exists() )
+        return; // the directory is notified when it is created again
+    // replaced files are dropped by QFileSystemWatcher
+    addPath( file );
+    notify( file );
+}
+
+void FileWatchService::directoryChangedSlot( const QString &dir )
+{
+    QStringList files = _directory_files.values( dir );
+    QStringList watched = _watcher.files();
+    for ( QStringList::const_iterator itFile = files.begin(); itFile != files.end(); ++itFile )
+    {
+        if ( !watched.contains( *itFile ) && QFileInfo( *itFile ).exists() )
+        {
+            addPath( *itFile );
+            notify( *itFile );
+        }
+    }
+}
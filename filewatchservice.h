@@ -0,0 +1,41 @@
+#ifndef FILE_WATCH_SERVICE_H
+#define FILE_WATCH_SERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QMultiHash>
+#include <QFileSystemWatcher>
+
+class FileSystemWatcher;
+
+// Process-wide file watcher: all the subscribed files and their directories
+// are multiplexed on one QFileSystemWatcher (one inotify instance on Linux).
+// Paths are reference counted and a change is dispatched only to the
+// subscribers of the modified file.
+class FileWatchService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FileWatchService *instance();
+    void subscribe( FileSystemWatcher *subscriber_p, const QString &file );
+    void unsubscribe( FileSystemWatcher *subscriber_p, const QString &file );
+
+private slots:
+    void fileChangedSlot( const QString & );
+    void directoryChangedSlot( const QString & );
+
+private:
+    FileWatchService();
+    void addPath( const QString & );
+    void notify( const QString &file );
+    static QString directory( const QString &file );
+
+    QFileSystemWatcher _watcher;
+    QMultiHash<QString,FileSystemWatcher*> _subscribers;
+    QHash<QString,int> _directory_references;
+    QMultiHash<QString,QString> _directory_files;
+};
+
+#endif
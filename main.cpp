@@ -2,6 +2,7 @@
 
 #include "mainwindow.h"
 #include "options.h"
+#include "tracer.h"
 
 #ifdef Q_WS_X11
 #include <QProcess>
@@ -39,6 +40,7 @@ int main( int argc, char *argv[] )
     qInstallMessageHandler( MessageOutput );
 
     Options::read_options();
+    Tracer::startFromEnvironment();
 #ifdef Q_WS_X11
     if (XOpenDisplay(NULL) == 0)
         return 1;
@@ -57,6 +59,8 @@ int main( int argc, char *argv[] )
     }
 
     Options::save_options();
+    if ( !Tracer::stop() )
+        fprintf( stderr, "Unable to write the trace file.\n" );
 
     return ret;
 }
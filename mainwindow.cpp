@@ -8,6 +8,11 @@
 #include "ocamlbreakpoint.h"
 #include "ocamlstack.h"
 #include "ocamlwatch.h"
+#include "ocamlstatistics.h"
+#include "ocamllogpoints.h"
+#include "stressharness.h"
+#include "moduleindex.h"
+#include "tracer.h"
 #include <QFileInfo>
 #include <QFileSystemModel>
 #include <QAction>
@@ -30,6 +35,8 @@ MainWindow::MainWindow(const Arguments &arguments) : _arguments( arguments )
     ocamlbreakpoints_dock  = NULL;
     ocamlbreakpoints  = NULL;
     ocamlstack_dock  = NULL;
+    ocamlstatistics_dock  = NULL;
+    ocamllogpoints_dock  = NULL;
     ocamlstack  = NULL;
     ocamlrun_dock  = NULL;
     filebrowser_dock  = NULL;
@@ -92,6 +99,10 @@ MainWindow::~MainWindow()
 void MainWindow::createDockWindows()
 {
     Arguments args( _arguments );
+    _module_index_p = new ModuleIndex( this );
+    _module_index_p->fromStringList( Options::get_opt_strlst( "MODULE_INDEX" ) );
+    connect( _module_index_p, SIGNAL( indexChanged() ), this, SLOT( moduleIndexChanged() ) );
+
     filebrowser_dock = new QDockWidget( tr( "Source File Browser" ), this );
     filebrowser_dock->setAllowedAreas( Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea );
     filebrowser = new QTreeView( );
@@ -136,9 +147,11 @@ void MainWindow::createDockWindows()
     ocamldebug_dock->setAllowedAreas( Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea );
     ocamldebug = new OCamlDebug( ocamldebug_dock , ocamlrun, _ocamldebug, args, _ocamldebug_init_script );
     ocamldebug_dock->setObjectName("OCamlDebugDock");
+    if ( StressHarness::requestedSteps() > 0 )
+        new StressHarness( this, ocamldebug, StressHarness::requestedSteps(), StressHarness::requestedReport() );
     connect ( ocamldebug , SIGNAL( stopDebugging( const QString &, int , int , bool) ) , this ,SLOT( stopDebugging( const QString &, int , int , bool) ) );
+    connect ( ocamldebug , SIGNAL( frameSelected( const QString &, int , int , bool) ) , this ,SLOT( stopDebugging( const QString &, int , int , bool) ) );
     connect ( ocamldebug , SIGNAL( debuggerStarted( bool) ) , this ,SLOT( debuggerStarted( bool) ) );
-    connect ( ocamldebug , SIGNAL( breakPointList( const BreakPoints &) ) , this ,SLOT( breakPointList( const BreakPoints &) ) );
     connect ( ocamldebug , SIGNAL( debuggerStarted( bool) ) , ocamlrun ,SLOT( debuggerStarted( bool) ) );
     ocamldebug_dock->setWidget( ocamldebug );
     ocamldebug_dock->toggleViewAction()->setIcon( QIcon( ":/images/oqamldebug.png" ) );
@@ -157,7 +170,7 @@ void MainWindow::createDockWindows()
     ocamlbreakpoints = new OCamlBreakpoint( ocamlbreakpoints_dock );
     ocamlbreakpoints_dock->setObjectName("Breakpoints");
     connect( ocamlbreakpoints, SIGNAL( debugger( const DebuggerCommand & ) ), ocamldebug, SLOT( debugger( const DebuggerCommand & ) ) );
-    connect ( ocamldebug , SIGNAL( stopDebugging( const QString &, int , int , bool) ) , ocamlbreakpoints  ,SLOT( stopDebugging( const QString &, int , int , bool) ) );
+    connect( ocamlbreakpoints, SIGNAL( breakpointCondition( int, const QString &, int ) ), ocamldebug, SLOT( setBreakpointCondition( int, const QString &, int ) ) );
     connect ( ocamldebug , SIGNAL( debuggerStarted( bool) ) , ocamlbreakpoints  ,SLOT( debuggerStarted( bool) ) );
     connect ( ocamldebug , SIGNAL( breakPointList( const BreakPoints &) ) , ocamlbreakpoints ,SLOT( breakPointList( const BreakPoints &) ) );
     connect ( ocamldebug , SIGNAL( breakPointHit( const QList<int> &) ) , ocamlbreakpoints ,SLOT( breakPointHit( const QList<int> &) ) );
@@ -181,6 +194,24 @@ void MainWindow::createDockWindows()
     ocamlstack_dock->toggleViewAction()->setIcon( QIcon( ":/images/callstack.png" ) );
     windowMenu->addAction( ocamlstack_dock->toggleViewAction() );
     debugWindowToolBar->addAction( ocamlstack_dock->toggleViewAction() );
+
+    ocamlstatistics_dock = new QDockWidget( tr( "Command Statistics" ), this );
+    ocamlstatistics_dock->setAllowedAreas( Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea );
+    ocamlstatistics_dock->setObjectName("CommandStatistics");
+    ocamlstatistics_dock->setWidget( new OCamlStatistics( ocamlstatistics_dock, ocamldebug->engine() ) );
+    addDockWidget( Qt::BottomDockWidgetArea, ocamlstatistics_dock );
+    ocamlstatistics_dock->hide();
+    windowMenu->addAction( ocamlstatistics_dock->toggleViewAction() );
+
+    ocamllogpoints_dock = new QDockWidget( tr( "Logpoints" ), this );
+    ocamllogpoints_dock->setAllowedAreas( Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea );
+    ocamllogpoints_dock->setObjectName("Logpoints");
+    OCamlLogpoints *ocamllogpoints = new OCamlLogpoints( ocamllogpoints_dock );
+    connect ( ocamldebug , SIGNAL( logpointHit( int, int, const QString & ) ) , ocamllogpoints ,SLOT( logpointHit( int, int, const QString & ) ) );
+    ocamllogpoints_dock->setWidget( ocamllogpoints );
+    addDockWidget( Qt::BottomDockWidgetArea, ocamllogpoints_dock );
+    ocamllogpoints_dock->hide();
+    windowMenu->addAction( ocamllogpoints_dock->toggleViewAction() );
 }
 
 void MainWindow::createWatchWindow()
@@ -205,8 +236,11 @@ void MainWindow::createWatchWindow( int watch_id )
     dock->setAllowedAreas( Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea | Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea );
     OCamlWatch *ocamlwatch = new OCamlWatch( dock, watch_id );
     connect ( ocamldebug , SIGNAL( stopDebugging( const QString &, int , int , bool) ) , ocamlwatch ,SLOT( stopDebugging( const QString &, int , int , bool) ) );
+    connect ( ocamldebug , SIGNAL( frameSelected( const QString &, int , int , bool) ) , ocamlwatch ,SLOT( stopDebugging( const QString &, int , int , bool) ) );
     connect ( ocamldebug , SIGNAL( debuggerCommand( const QString &, const QString &) ) , ocamlwatch ,SLOT( debuggerCommand( const QString &, const QString &) ) );
     connect( ocamlwatch, SIGNAL( debugger( const DebuggerCommand & ) ), ocamldebug, SLOT( debugger( const DebuggerCommand & ) ) );
+    connect( ocamlwatch, SIGNAL( findChange( const QString & ) ), ocamldebug, SLOT( findValueChange( const QString & ) ) );
+    connect( ocamlwatch, SIGNAL( runUntilChange( const QString & ) ), ocamldebug, SLOT( runUntilValueChange( const QString & ) ) );
     connect( ocamlwatch, SIGNAL( destroyed( QObject* ) ), this, SLOT( watchWindowDestroyed( QObject* ) ) );
     connect ( ocamldebug , SIGNAL( debuggerStarted( bool) ) , ocamlwatch ,SLOT( debuggerStarted( bool) ) );
     dock->setObjectName(QString("OCamlWatchDock%1").arg( QString::number(watch_id) ));
@@ -248,6 +282,7 @@ void MainWindow::closeEvent( QCloseEvent *event )
 
 QMdiSubWindow* MainWindow::openOCamlSource(const QString &fileName, bool from_user_loaded)
 {
+    TRACE_SCOPE( "MainWindow::openOCamlSource" );
     if ( !fileName.isEmpty() )
     {
         QMdiSubWindow *existing = findMdiChild( fileName );
@@ -289,8 +324,6 @@ QMdiSubWindow* MainWindow::openOCamlSource(const QString &fileName, bool from_us
         if ( child->loadFile( fileName ) )
         {
             statusBar()->showMessage( tr( "File loaded" ), 2000 );
-            if ( ocamldebug )
-                child->breakPointList( ocamldebug->breakpoints() );
             child->show();
         }
         else
@@ -435,6 +468,10 @@ void MainWindow::updateWindowMenu()
         windowMenu->addAction( ocamlstack_dock->toggleViewAction() );
     if ( ocamlrun_dock )
         windowMenu->addAction( ocamlrun_dock->toggleViewAction() );
+    if ( ocamlstatistics_dock )
+        windowMenu->addAction( ocamlstatistics_dock->toggleViewAction() );
+    if ( ocamllogpoints_dock )
+        windowMenu->addAction( ocamllogpoints_dock->toggleViewAction() );
 
     windowMenu->addAction( separatorAct );
     QList<QMdiSubWindow *> windows = mdiArea->subWindowList();
@@ -471,6 +508,8 @@ void MainWindow::updateWindowMenu()
 OCamlSource *MainWindow::createMdiChild()
 {
     OCamlSource *child = new OCamlSource;
+    if ( ocamldebug )
+        child->setBreakpointIndex( &ocamldebug->engine()->breakpointIndex() );
     mdiArea->addSubWindow( child );
 
     connect( child, SIGNAL( copyAvailable( bool ) ),
@@ -479,6 +518,9 @@ OCamlSource *MainWindow::createMdiChild()
     connect( child, SIGNAL( debugger( const DebuggerCommand & ) ),
              ocamldebug, SLOT( debugger( const DebuggerCommand & ) ) );
 
+    connect( child, SIGNAL( logpoint( const QString &, const QStringList & ) ),
+             ocamldebug, SLOT( setLogpoint( const QString &, const QStringList & ) ) );
+
     connect( child, SIGNAL( releaseFocus() ),
              this, SLOT( ocamlDebugFocus() ) );
 
@@ -760,12 +802,16 @@ void MainWindow::setActiveSubWindow( QWidget *window )
 
 void MainWindow::stopDebugging( const QString &file, int start_char, int end_char, bool after) 
 {
+    TRACE_SCOPE( "MainWindow::stopDebugging" );
     statusBar()->showMessage( QString() );
     if ( ! file.isEmpty() )
     {
-        openOCamlSource( file , false );
+        QString source = _module_index_p->resolve( file );
+        if ( source.isEmpty() )
+            source = file;
+        openOCamlSource( source , false );
         OCamlSource *current_source_p = activeMdiChild();
-        QString text = current_source_p->stopDebugging( file, start_char, end_char, after) ;
+        QString text = current_source_p->stopDebugging( source, start_char, end_char, after) ;
         if ( ! text.isEmpty() )
         {
             if (after)
@@ -796,13 +842,13 @@ void MainWindow::ocamlDebugFocus()
 void MainWindow::debugUp()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "up", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
+        ocamldebug->debuggerStep( "up" );
 }
 
 void MainWindow::debugDown()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "down",DebuggerCommand::HIDE_DEBUGGER_OUTPUT) );
+        ocamldebug->debuggerStep( "down" );
 }
 
 void MainWindow::debugInterrupt()
@@ -832,40 +878,52 @@ void MainWindow::debugReverse()
 void MainWindow::debugStep()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "step", DebuggerCommand::HIDE_DEBUGGER_OUTPUT) );
+        ocamldebug->debuggerStep( "step" );
 }
 
 void MainWindow::debugBackStep()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "backstep", DebuggerCommand::HIDE_DEBUGGER_OUTPUT) );
+        ocamldebug->debuggerStep( "backstep" );
 }
 
 void MainWindow::debugNext()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "next", DebuggerCommand::HIDE_DEBUGGER_OUTPUT) );
+        ocamldebug->debuggerStep( "next" );
 }
 
 void MainWindow::debugPrevious()
 {
     if (ocamldebug)
-        ocamldebug->debugger( DebuggerCommand( "previous", DebuggerCommand::HIDE_DEBUGGER_OUTPUT) );
+        ocamldebug->debuggerStep( "previous" );
 }
 
-void MainWindow::breakPointList(const BreakPoints &b)
+void MainWindow::debuggerStarted(bool b)
 {
-    foreach ( QMdiSubWindow * window, mdiArea->subWindowList() )
-    {
-        OCamlSource *mdiChild = qobject_cast<OCamlSource *>( window->widget() );
-        if (mdiChild)
-            mdiChild->breakPointList( b );
-    }
+    debuggerStartAct->setChecked(b) ;
+    if (b)
+        sendSourceDirectories();
 }
 
-void MainWindow::debuggerStarted(bool b)
+void MainWindow::moduleIndexChanged()
 {
-    debuggerStartAct->setChecked(b) ;
+    Options::set_opt( "MODULE_INDEX", _module_index_p->toStringList() );
+    sendSourceDirectories();
+}
+
+void MainWindow::sendSourceDirectories()
+{
+    if ( !ocamldebug || !ocamldebug->engine()->isRunning() )
+        return;
+    QStringList directories;
+    foreach ( const QString &directory, _module_index_p->directories() )
+    {
+        if ( !directory.contains( ' ' ) ) // ocamldebug splits its arguments at spaces
+            directories << directory;
+    }
+    if ( !directories.isEmpty() )
+        ocamldebug->debugger( DebuggerCommand( "directory " + directories.join( " " ), DebuggerCommand::HIDE_ALL_OUTPUT ) );
 }
 
 void MainWindow::debuggerStart(bool b)
@@ -932,10 +990,15 @@ void MainWindow::fileBrowserPathChanged( const QString &path )
         label_p->setText( path );
         Options::set_opt( "SOURCE_DIRECTORY", path );
     }
+    _module_index_p->scan( path );
 }
 
 QString MainWindow::findOCamlDebug() const 
 {
+    const QString ocamldebug = ::getenv( "OQAMLDEBUG_OCAMLDEBUG" );
+    if ( !ocamldebug.isEmpty() )
+        return ocamldebug;
+
     const QString path = ::getenv( "PATH" );
 #if Q_OS_WIN32
     const QString path_separator = ";";
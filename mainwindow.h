@@ -10,6 +10,7 @@ class OCamlStack;
 class OCamlBreakpoint;
 class OCamlDebug;
 class OCamlWatch;
+class ModuleIndex;
 QT_BEGIN_NAMESPACE
 class QAction;
 class QTreeView;
@@ -39,7 +40,6 @@ private slots:
     void copy();
     void debuggerStart(bool);
     void debuggerStarted(bool b);
-    void breakPointList(const BreakPoints &b);
     void debugRun();
     void debugUp();
     void debugDown();
@@ -68,6 +68,7 @@ private slots:
     void watchVariable( const QString & );
     void fileBrowserItemActivated( const QModelIndex &item ) ;
     void fileBrowserPathChanged( const QString &path );
+    void moduleIndexChanged();
 
 private:
     void createWatchWindow( int watch_id );
@@ -78,6 +79,7 @@ private:
     void readSettings();
     void writeSettings();
     void createDockWindows();
+    void sendSourceDirectories();
     OCamlSource *activeMdiChild();
     OCamlDebug *ocamldebug ;
     OCamlBreakpoint *ocamlbreakpoints ;
@@ -85,6 +87,7 @@ private:
     OCamlRun *ocamlrun ;
     QTreeView *filebrowser ;
     QFileSystemModel *filebrowser_model_p ;
+    ModuleIndex *_module_index_p ;
     QMdiSubWindow *findMdiChild(const QString &fileName);
     QMdiSubWindow *findMdiChildNotLoadedFromUser();
 
@@ -136,6 +139,8 @@ private:
     QDockWidget *ocamldebug_dock ;
     QDockWidget *ocamlbreakpoints_dock ;
     QDockWidget *ocamlstack_dock ;
+    QDockWidget *ocamlstatistics_dock ;
+    QDockWidget *ocamllogpoints_dock ;
     QDockWidget *ocamlrun_dock ;
     QDockWidget *filebrowser_dock ;
 
@@ -0,0 +1,113 @@
+#include "moduleindex.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+
+ModuleIndex::ModuleIndex( QObject *parent_p ) : QObject( parent_p ),
+    _scanner_p( NULL )
+{
+}
+
+ModuleIndex::~ModuleIndex()
+{
+    if ( _scanner_p )
+    {
+        _scanner_p->requestInterruption();
+        _scanner_p->wait();
+    }
+}
+
+// OCaml capitalizes the first letter of the file name only
+QString ModuleIndex::moduleName( const QString &file )
+{
+    QString module = QFileInfo( file ).baseName();
+    if ( !module.isEmpty() )
+        module[0] = module[0].toUpper();
+    return module;
+}
+
+QString ModuleIndex::resolve( const QString &file ) const
+{
+    QString path = source( moduleName( file ) );
+    if ( !path.isEmpty() && QFileInfo( path ).fileName() == QFileInfo( file ).fileName() )
+        return path;
+    return QString();
+}
+
+QStringList ModuleIndex::directories() const
+{
+    QSet<QString> directories;
+    for ( QHash<QString,QString>::const_iterator itSource = _sources.begin(); itSource != _sources.end(); ++itSource )
+        directories.insert( QFileInfo( itSource.value() ).absolutePath() );
+    QStringList result = directories.toList();
+    result.sort();
+    return result;
+}
+
+QStringList ModuleIndex::toStringList() const
+{
+    QStringList result;
+    for ( QHash<QString,QString>::const_iterator itSource = _sources.begin(); itSource != _sources.end(); ++itSource )
+        result << itSource.key() + '\t' + itSource.value();
+    result.sort();
+    return result;
+}
+
+void ModuleIndex::fromStringList( const QStringList &entries )
+{
+    _sources.clear();
+    for ( QStringList::const_iterator itEntry = entries.begin(); itEntry != entries.end(); ++itEntry )
+    {
+        int separator = itEntry->indexOf( '\t' );
+        if ( separator > 0 )
+            _sources.insert( itEntry->left( separator ), itEntry->mid( separator + 1 ) );
+    }
+}
+
+void ModuleIndex::scan( const QString &root )
+{
+    if ( _scanner_p )
+    {
+        // restarted when the running scan is finished
+        _pending_root = root;
+        _scanner_p->requestInterruption();
+        return;
+    }
+    _pending_root.clear();
+    _scanner_p = new ModuleIndexScanner( root, this );
+    connect( _scanner_p, SIGNAL( finished() ), this, SLOT( scanFinished() ) );
+    _scanner_p->start( QThread::LowPriority );
+}
+
+void ModuleIndex::scanFinished()
+{
+    if ( !_scanner_p->isInterruptionRequested() && _scanner_p->sources() != _sources )
+    {
+        _sources = _scanner_p->sources();
+        emit indexChanged();
+    }
+    _scanner_p->deleteLater();
+    _scanner_p = NULL;
+    if ( !_pending_root.isEmpty() )
+        scan( _pending_root );
+}
+
+void ModuleIndexScanner::run()
+{
+    QDir root( _root );
+    QDirIterator it( _root, QStringList() << "*.ml", QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() && !isInterruptionRequested() )
+    {
+        QString path = it.next();
+        QString relative = "/" + root.relativeFilePath( path );
+        if ( relative.contains( "/." ) )
+            continue; // hidden directories (.git, ...)
+        path = QFileInfo( path ).canonicalFilePath();
+        QString module = ModuleIndex::moduleName( path );
+        bool build = relative.contains( "/_build/" );
+        QString existing = _sources.value( module );
+        if ( existing.isEmpty() || ( ( "/" + root.relativeFilePath( existing ) ).contains( "/_build/" ) && !build ) )
+            _sources.insert( module, path );
+    }
+}
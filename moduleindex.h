@@ -0,0 +1,62 @@
+#ifndef MODULEINDEX_H
+#define MODULEINDEX_H
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+class ModuleIndexScanner;
+
+// Map from the OCaml module names to their source files.
+// The source trees are scanned in a background thread; files of the dune
+// _build tree are only used for modules without a file in the source tree.
+class ModuleIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    ModuleIndex( QObject *parent_p );
+    virtual ~ModuleIndex();
+    static QString moduleName( const QString &file );
+    QString source( const QString &module ) const { return _sources.value( module ); }
+    QString resolve( const QString &file ) const;
+    QStringList directories() const;
+    bool isEmpty() const { return _sources.isEmpty(); }
+    // "Module\tpath" entries, used to persist the index between runs
+    QStringList toStringList() const;
+    void fromStringList( const QStringList & );
+
+public slots:
+    void scan( const QString &root );
+
+private slots:
+    void scanFinished();
+
+signals:
+    void indexChanged();
+
+private:
+    QHash<QString,QString> _sources;
+    ModuleIndexScanner *_scanner_p;
+    QString _pending_root;
+};
+
+class ModuleIndexScanner : public QThread
+{
+    Q_OBJECT
+
+public:
+    ModuleIndexScanner( const QString &root, QObject *parent_p ) : QThread( parent_p ), _root( root ) { }
+    const QHash<QString,QString> & sources() const { return _sources; }
+
+protected:
+    void run();
+
+private:
+    QString _root;
+    QHash<QString,QString> _sources;
+};
+
+#endif
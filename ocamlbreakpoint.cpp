@@ -1,10 +1,11 @@
 #include <QtGui>
 #include <QtDebug>
-#include <QTreeWidgetItem>
-#include <QStringListModel>
 #include "ocamlbreakpoint.h"
 #include "options.h"
+#include "tracer.h"
 #include <QHeaderView>
+#include <QMenu>
+#include <QInputDialog>
 
 OCamlBreakpoint::OCamlBreakpoint( QWidget *parent_p ) : 
     QWidget(parent_p)
@@ -12,20 +13,23 @@ OCamlBreakpoint::OCamlBreakpoint( QWidget *parent_p ) :
     setObjectName( "OCamlBreakpoint" );
 
     layout_p = new QVBoxLayout( );
-    breakpoints_p = new QTreeWidget() ;
-    connect( breakpoints_p, SIGNAL( itemClicked ( QTreeWidgetItem * , int ) ), this, SLOT( expressionClicked( QTreeWidgetItem * , int ) ) );
+    model_p = new BreakpointModel( this );
+    proxy_p = new QSortFilterProxyModel( this );
+    proxy_p->setSourceModel( model_p );
+    breakpoints_p = new QTreeView() ;
+    breakpoints_p->setModel( proxy_p );
+    connect( breakpoints_p, SIGNAL( clicked( const QModelIndex & ) ), this, SLOT( expressionClicked( const QModelIndex & ) ) );
     layout_p->addWidget( breakpoints_p );
     layout_p->setContentsMargins( 0,0,0,0 );
     setLayout( layout_p );
 
-    QStringList headers ;
-    headers << tr( "Del" ) << tr("Id") << tr("From") << tr("To") << tr("File") ;
+    QIcon delete_icon = QIcon( ":/images/delete.png" );
     breakpoints_p->setRootIsDecorated(false);
-    breakpoints_p->setColumnCount( headers.count() );
-    breakpoints_p->setHeaderLabels( headers );
-    breakpoints_p->header()->setSectionResizeMode( 0, QHeaderView::ResizeToContents );
-    clearData();
+    breakpoints_p->setUniformRowHeights( true );
     breakpoints_p->header()->restoreState( Options::get_opt_array( "OCamlBreakpoint_State" ) );
+    breakpoints_p->header()->resizeSection( BreakpointModel::DELETE_COLUMN, delete_icon.availableSizes().at(0).width() ); 
+    breakpoints_p->header()->setSectionResizeMode( BreakpointModel::DELETE_COLUMN, QHeaderView::Fixed ); 
+    breakpoints_p->header()->setSectionResizeMode( BreakpointModel::TO_COLUMN, QHeaderView::ResizeToContents ); 
     breakpoints_p->setSortingEnabled( true );
 
     setAttribute(Qt::WA_DeleteOnClose);
@@ -41,9 +45,7 @@ OCamlBreakpoint::~OCamlBreakpoint()
 
 void OCamlBreakpoint::clearData()
 {
-    breakpoints_p->clear();
-    _breakpoint_hit.clear();
-    _breakpoints.clear();
+    model_p->clear();
 }
 
 void OCamlBreakpoint::closeEvent(QCloseEvent *event)
@@ -51,52 +53,45 @@ void OCamlBreakpoint::closeEvent(QCloseEvent *event)
     event->accept();
 }
 
-void OCamlBreakpoint::stopDebugging( const QString &, int , int , bool) 
+void OCamlBreakpoint::expressionClicked( const QModelIndex &index )
 {
-    updateBreakpoints();
+    if ( index.isValid() && index.column() == BreakpointModel::DELETE_COLUMN )
+    {
+        int id = model_p->breakpointId( proxy_p->mapToSource( index ) );
+        if ( id >= 0 )
+            emit debugger( DebuggerCommand( "del " + QString::number(id), DebuggerCommand::HIDE_ALL_OUTPUT ) );
+    }
 }
 
-void  OCamlBreakpoint::updateBreakpoints()
+void OCamlBreakpoint::contextMenuEvent(QContextMenuEvent *event)
 {
-    breakpoints_p->clear();
-    for (BreakPoints::Iterator itBreakpoint = _breakpoints.begin() ; itBreakpoint != _breakpoints.end() ; ++itBreakpoint )
-    {
-        QStringList item ;
-        item 
-            << "" 
-            << QString::number( itBreakpoint->id )
-            << QString::number( itBreakpoint->fromLine ) + ":" + QString::number( itBreakpoint->fromColumn ) 
-            << QString::number( itBreakpoint->toLine ) + ":" + QString::number( itBreakpoint->toColumn ) 
-            << itBreakpoint->file.simplified()
-            ;
-        QTreeWidgetItem *item_p = new QTreeWidgetItem( item );
-        bool hit = _breakpoint_hit.contains( itBreakpoint->id );
-        if ( hit )
-            for ( int i=1 ; i<5 ; i++ )
-                item_p->setBackgroundColor( i, QColor( Qt::yellow ) );
-        item_p->setFlags( Qt::ItemIsEnabled );
-        QIcon delete_icon = QIcon( ":/images/delete.png" );
-        item_p->setIcon( 0, delete_icon );
-        item_p->setToolTip( 0, tr( "Click to delete this breakpoint." ) );
-        item_p->setSizeHint( 0, delete_icon.availableSizes().at(0) );
-        breakpoints_p->header()->resizeSection( 0, delete_icon.availableSizes().at(0).width() ); 
-        breakpoints_p->header()->setSectionResizeMode( 0, QHeaderView::Fixed ); 
-        breakpoints_p->header()->setSectionResizeMode( 3, QHeaderView::ResizeToContents ); 
-
-        breakpoints_p->addTopLevelItem( item_p );
-    }
+    QModelIndex index = breakpoints_p->indexAt( breakpoints_p->viewport()->mapFrom( this, event->pos() ) );
+    if ( !index.isValid() )
+        return;
+    breakpoints_p->setCurrentIndex( index );
+    QMenu menu( this );
+    menu.addAction( tr( "Set &Condition..." ), this, SLOT( editCondition() ) );
+    menu.exec( event->globalPos() );
 }
 
-void OCamlBreakpoint::expressionClicked( QTreeWidgetItem *item_p , int column )
+void OCamlBreakpoint::editCondition()
 {
-    if (item_p && column==0)
-    {
-        bool ok;
-        QString sid = item_p->text(1);
-        int id = sid.toInt( &ok );
-        if ( ok )
-            emit debugger( DebuggerCommand( "del " + QString::number(id), DebuggerCommand::HIDE_ALL_OUTPUT ) );
-    }
+    QModelIndex index = proxy_p->mapToSource( breakpoints_p->currentIndex() );
+    int id = model_p->breakpointId( index );
+    if ( id < 0 )
+        return;
+
+    bool ok;
+    QString condition = QInputDialog::getText( this, tr( "Breakpoint %1" ).arg( id ),
+            tr( "Stop only if (e.g. 'i >= 100', empty for always):" ), QLineEdit::Normal,
+            model_p->breakpoint( index ).condition, &ok );
+    if ( !ok )
+        return;
+    int hit_count = QInputDialog::getInt( this, tr( "Breakpoint %1" ).arg( id ),
+            tr( "Stop from the hit:" ), qMax( 1, model_p->breakpoint( index ).hitCount ), 1, 2147483647, 1, &ok );
+    if ( !ok )
+        return;
+    emit breakpointCondition( id, condition, hit_count );
 }
 
 void OCamlBreakpoint::debuggerStarted( bool b )
@@ -106,13 +101,11 @@ void OCamlBreakpoint::debuggerStarted( bool b )
 
 void  OCamlBreakpoint::breakPointList( const BreakPoints &b )
 {
-    _breakpoints = b;
-    updateBreakpoints();
+    model_p->setBreakpoints( b );
 }
 
 void  OCamlBreakpoint::breakPointHit( const QList<int> &h )
 {
-    _breakpoint_hit = h;
-    updateBreakpoints();
+    TRACE_SCOPE( "OCamlBreakpoint::breakPointHit" );
+    model_p->setHits( h );
 }
-
@@ -6,10 +6,10 @@
 #include <QStringList>
 #include <QVBoxLayout>
 #include <QWidget>
-#include <QLabel>
-#include <QTreeWidget>
-#include <QCompleter>
+#include <QTreeView>
+#include <QSortFilterProxyModel>
 #include "breakpoint.h"
+#include "breakpointmodel.h"
 #include "debuggercommand.h"
 
 class OCamlBreakpoint : public QWidget
@@ -22,24 +22,24 @@ public:
 
 signals:
     bool debugger( const DebuggerCommand & ) ;
+    void breakpointCondition( int id, const QString &condition, int hit_count );
 public slots:
-    void updateBreakpoints();
-    void stopDebugging( const QString &, int , int , bool) ;
     void debuggerStarted( bool );
     void  breakPointList( const BreakPoints & );
     void  breakPointHit( const QList<int> & );
 protected slots:
-    void expressionClicked( QTreeWidgetItem * , int );
+    void expressionClicked( const QModelIndex & );
+    void editCondition();
 protected:
     void closeEvent(QCloseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
 
 private:
-    QList<int> _breakpoint_hit ;
-    BreakPoints _breakpoints;
     void clearData();
     QVBoxLayout *layout_p;
-    QTreeWidget *breakpoints_p;
+    QTreeView *breakpoints_p;
+    BreakpointModel *model_p;
+    QSortFilterProxyModel *proxy_p;
 };
 
 #endif
-
@@ -1,43 +1,58 @@
 #include <QtGui>
 #include <QtDebug>
-#include <QTcpServer>
 #include <QMessageBox>
 #include <QToolTip>
 #include <QMenu>
+#include <QInputDialog>
+#include <QScrollBar>
+#include <QHBoxLayout>
+#include <QCoreApplication>
 #include "ocamldebughighlighter.h"
 #include "ocamldebug.h"
+#include "tracer.h"
 #include "ocamlrun.h"
 #include "options.h"
-#if !defined(Q_OS_WIN32)
-#include <sys/types.h>
-#include <signal.h>
-#endif
+#include "updatescheduler.h"
+#include "valuesearch.h"
 
 
 OCamlDebug::OCamlDebug( QWidget *parent_p , OCamlRun *ocamlrun_p, const QString &ocamldebug, const Arguments &arguments, const QString & init_script ) : QPlainTextEdit(parent_p),
-    emacsLineInfoRx("^\\x001A\\x001AM([^:].[^:]*):([^:]*):([^:]*):([^:\\n]*)\\n*$") ,
-    readyRx("^\\(ocd\\) *") ,
-    deleteBreakpointRx("^Removed breakpoint ([0-9]+) at [0-9]+ *: .*$"),
-    hitBreakpointRx("^Breakpoints? :( [0-9]+)+ ?\\n?$"),
-    hitBreakpointIdRx("( [0-9]+)"),
-    newBreakpointRx("^Breakpoint ([0-9]+) at [0-9]+ *: file ([^,]*), line ([0-9]+), characters ([0-9]+)-([0-9]+).*$"),
-    emacsHaltInfoRx("^\\x001A\\x001AH.*$"),
-    timeInfoRx("^Time *: *([0-9]+)( - pc *: *([0-9]+) - .*)?\\n?$"),
-    ocamlrunConnectionRx("^Waiting for connection\\.\\.\\.\\(the socket is [a-z.0-9_A-Z]*:[0-9]+\\)\\n?$"),
-    _ocamldebug_init_script( init_script ),
-    _arguments( arguments ),
+    _input_p( NULL ),
     _ocamlrun_p( ocamlrun_p ),
-    _port_min( 18000 ),
-    _port_max( 18999 )
-{
-    _current_port = Options::get_opt_int( "OCAMLDEBUG_PORT", _port_min ) ;
-    _debuggerOutputsRx.append( QRegExp( "^No such frame\\.\\n?$" ) );
-    _debuggerOutputsRx.append( QRegExp( "^#([0-9]+)  *Pc *: *[0-9]+ .*$" ) );
-    _debuggerOutputsRx.append( QRegExp( "^Loading program\\.\\.\\.[\\n ]+$" ) );
-    _debuggerOutputsRx.append( QRegExp( "^done\\.[\\n ]+$" ) );
-    _display_all_commands = Options::get_opt_bool( "DISPLAY_ALL_OCAMLDEBUG_COMMANDS", false );
+    _step_count( 0 ),
+    _wheel_delta( 0 )
+{
+    _engine_p = new OCamlDebugEngine( this, ocamldebug, arguments, init_script );
+    _engine_p->setPort( Options::get_opt_int( "OCAMLDEBUG_PORT", 18000 ) );
+    _engine_p->setUnixSocket( Options::get_opt_bool( "OCAMLDEBUG_UNIX_SOCKET", true ) );
+    _engine_p->setSettleTime( Options::get_opt_int( "APPLICATION_SETTLE_TIME", 500 ) );
+    _engine_p->setWarmStandby( Options::get_opt_bool( "OCAMLDEBUG_WARM_STANDBY", false ) );
+    _engine_p->setDisplayAllCommands( Options::get_opt_bool( "DISPLAY_ALL_OCAMLDEBUG_COMMANDS", false ) );
+    _engine_p->setStepFilters( Options::get_opt_strlst( "OCAMLDEBUG_STEP_FILTERS" ) );
+    _engine_p->setBreakpointCommands( Options::get_opt_strlst( "BREAKPOINT_COMMANDS" ) );
+    _engine_p->setLogpoints( Options::get_opt_strlst( "LOGPOINTS" ) );
+    _engine_p->setBreakpointConditions( Options::get_opt_strlst( "BREAKPOINT_CONDITIONS" ) );
+    connect( _engine_p, SIGNAL( stopDebugging( const QString &, int , int , bool) ), this, SLOT( engineStopDebugging( const QString &, int , int , bool) ) );
+    connect( _engine_p, SIGNAL( frameSelected( const QString &, int , int , bool) ), this, SLOT( engineFrameSelected( const QString &, int , int , bool) ) );
+    connect( _engine_p, SIGNAL( breakPointList( const BreakPoints & ) ), this, SIGNAL( breakPointList( const BreakPoints & ) ) );
+    connect( _engine_p, SIGNAL( breakPointHit( const QList<int> & ) ), this, SLOT( engineBreakPointHit( const QList<int> & ) ) );
+    connect( _engine_p, SIGNAL( debuggerStarted( bool ) ), this, SIGNAL( debuggerStarted( bool ) ) );
+    connect( _engine_p, SIGNAL( debuggerCommand( const QString &, const QString & ) ), this, SLOT( engineDebuggerCommand( const QString &, const QString & ) ) );
+    connect( _engine_p, SIGNAL( logpointHit( int, int, const QString & ) ), this, SIGNAL( logpointHit( int, int, const QString & ) ) );
+    connect( _engine_p, SIGNAL( logpointsChanged( const QStringList & ) ), this, SLOT( saveLogpoints( const QStringList & ) ) );
+    connect( _engine_p, SIGNAL( breakpointConditionsChanged( const QStringList & ) ), this, SLOT( saveBreakpointConditions( const QStringList & ) ) );
+    _value_search_p = new ValueSearch( _engine_p );
+    connect( _value_search_p, SIGNAL( finished( const QString &, bool, int ) ), this, SLOT( valueSearchFinished( const QString &, bool, int ) ) );
+    connect( _engine_p, SIGNAL( breakpointCommandsChanged( const QStringList & ) ), this, SLOT( saveBreakpoints( const QStringList & ) ) );
+    connect( _engine_p, SIGNAL( output( const QString & ) ), this, SLOT( engineOutput( const QString & ) ) );
+    connect( _engine_p, SIGNAL( commandWritten( const QString &, bool ) ), this, SLOT( engineCommandWritten( const QString &, bool ) ) );
+    connect( _engine_p, SIGNAL( timeMarker( int ) ), this, SLOT( engineTimeMarker( int ) ) );
+    connect( _engine_p, SIGNAL( commandQueueChanged( ) ), this, SLOT( repaintDebugTimeArea( ) ) );
+    connect( _engine_p, SIGNAL( commandCompleted( const DebuggerCommand & ) ), this, SLOT( engineCommandCompleted( const DebuggerCommand & ) ) );
+    connect( _engine_p, SIGNAL( applicationConnection( const QString & ) ), this, SLOT( startApplication( const QString & ) ) );
+    connect( _engine_p, SIGNAL( applicationModified( ) ), this, SLOT( fileChanged( ) ) );
+    connect( _engine_p, SIGNAL( error( const QString &, const QString & ) ), this, SLOT( engineError( const QString &, const QString & ) ) );
 
-    file_watch_p = NULL;
     debugTimeArea = new OCamlDebugTime( this );
     connect( this, SIGNAL( blockCountChanged( int ) ), this, SLOT( updateDebugTimeAreaWidth( int ) ) );
     connect( this, SIGNAL( updateRequest( QRect, int ) ), this, SLOT( updateDebugTimeArea( QRect, int ) ) );
@@ -45,44 +60,35 @@ OCamlDebug::OCamlDebug( QWidget *parent_p , OCamlRun *ocamlrun_p, const QString
     updateDebugTimeAreaWidth( 0 );
     emit debuggerStarted( false );
     setEnabled( false );
-    _lru = Options::get_opt_strlst ("OCAMLDEBUG_COMMANDS");
-    setReadOnly( false );
+    setReadOnly( true );
+    setTextInteractionFlags( Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard );
     setUndoRedoEnabled( false );
     setAttribute(Qt::WA_DeleteOnClose);
     highlighter = new OCamlDebugHighlighter(this->document());
-    process_p = NULL;
     QFont font("Monospace");
     font.setStyleHint(QFont::TypeWriter);
     setFont(font);
-    setArguments( _arguments );
-    setOCamlDebug( ocamldebug );
 
-    setCursorWidth(3);
+    _input_p = new OCamlDebugInput( this );
+    updateDebugTimeAreaWidth( 0 );
 }
 
 OCamlDebug::~OCamlDebug()
 {
     emit debuggerStarted( false );
     disconnect() ;
+    _engine_p->disconnect( this ) ;
     clear();
-    if ( file_watch_p )
-        delete file_watch_p;
 }
 
 void OCamlDebug::clear()
 {
-    _command_line.clear();
-    _command_line_last.clear();
-    _cursor_position=0;
-    _lru_position = -1 ;
-    if ( process_p )
+    _step_command.clear();
+    _step_count = 0;
+    _pending_events.clear();
+    if ( _engine_p->isRunning() )
     {
-        process_p->terminate();
-        if (process_p->waitForFinished( 1000 ) )
-            process_p->kill();
-        process_p->close();
-        delete process_p;
-        process_p = NULL;
+        _engine_p->stop();
         setEnabled( false );
     }
     QPlainTextEdit::clear();
@@ -90,26 +96,25 @@ void OCamlDebug::clear()
 
 void OCamlDebug::setOCamlDebug( const QString &ocamldebug )
 {
-    _ocamldebug = ocamldebug ;
+    _engine_p->setOCamlDebug( ocamldebug );
 }
 
 void OCamlDebug::setArguments( const Arguments &arguments )
 {
-    _arguments = arguments ;
-    QString ocamlapp = _arguments.ocamlApp() ;
-    if ( file_watch_p )
-        delete file_watch_p;
-    file_watch_p = new FileSystemWatcher( ocamlapp );
-    connect ( file_watch_p , SIGNAL( fileChanged ( ) ) , this , SLOT( fileChanged () ) , Qt::QueuedConnection );
+    _engine_p->setArguments( arguments );
 }
 
 void OCamlDebug::fileChanged ( )
 {
     QTextCursor cur = textCursor();
     cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
-    cur.insertText("\n"+tr("Application %1 is modified.").arg( _arguments.ocamlApp() )+"\n");
+    cur.insertText("\n"+tr("Application %1 is modified.").arg( _engine_p->arguments().ocamlApp() )+"\n");
+    int time = _engine_p->isRunning() ? _engine_p->time() : -1;
     stopDebug();
     startDebug();
+    // return to the previous execution time, goto stops at the end if the new program is shorter
+    if ( time > 0 && _engine_p->isRunning() )
+        debugger( DebuggerCommand( "goto " + QString::number( time ), DebuggerCommand::SHOW_ALL_OUTPUT ) );
 }
 
 void OCamlDebug::startDebug()
@@ -130,176 +135,30 @@ void OCamlDebug::closeEvent(QCloseEvent *event)
     event->accept();
 }
 
+// The log is read-only: the keys which do not navigate in it are typed in the input line
 void OCamlDebug::keyPressEvent ( QKeyEvent * e )
 {
-     if (process_p)
-     {
-         switch (e->key())
-         {
-             case Qt::Key_PageDown: 
-             case Qt::Key_PageUp: 
-                 QPlainTextEdit::keyPressEvent ( e );
-                 break;
-             case Qt::Key_Delete: 
-                 {
-                     if (!_command_line.isEmpty() && _cursor_position>0)
-                     {
-                         QString command_line = _command_line.left(_cursor_position) + _command_line.mid(_cursor_position+1);
-                         _command_line = command_line;
-                         displayCommandLine();
-                     }
-                 }
-                 break;
-             case Qt::Key_Backspace: 
-                 {
-                     if (!_command_line.isEmpty() && _cursor_position>0)
-                     {
-                         QString command_line = _command_line.left(_cursor_position-1) + _command_line.mid(_cursor_position);
-                         _command_line = command_line;
-                         _cursor_position--;
-                         displayCommandLine();
-                     }
-                 }
-                 break;
-             case Qt::Key_Up: 
-                 {
-                     if ( e->modifiers() & Qt::ShiftModifier)
-                     {
-                         QPlainTextEdit::keyPressEvent ( e );
-                         break;
-                     }
-                     if (_lru.isEmpty())
-                         break;
-                     
-                     if ( _lru_position < 0 )
-                     {
-                         _command_line_backup = _command_line;
-                         _lru_position = _lru.size() - 1 ;
-                     }
-                     else if ( _lru_position == 0)
-                         break;
-                     else
-                         _lru_position--;
-                     _command_line = _lru.at( _lru_position );
-
-                     _cursor_position = _command_line.length();
-                     displayCommandLine();
-                 }
-                 break;
-             case Qt::Key_Down: 
-                 {
-                     if ( e->modifiers() & Qt::ShiftModifier)
-                     {
-                         QPlainTextEdit::keyPressEvent ( e );
-                         break;
-                     }
-                     if (_lru.isEmpty())
-                         break;
-                     if ( _lru_position < 0 )
-                         break;
-                     else if ( _lru_position == _lru.size()-1)
-                     {
-                         _lru_position = -1;
-                         _command_line = _command_line_backup;
-                     }
-                     else
-                     {
-                         _lru_position++;
-                         _command_line = _lru.at( _lru_position );
-                     }
-
-                     _cursor_position = _command_line.length();
-                     displayCommandLine();
-                 }
-                 break;
-             case Qt::Key_Right: 
-                 {
-                     _cursor_position++;
-                     if (_cursor_position > _command_line.length())
-                         _cursor_position = _command_line.length();
-                     else
-                         displayCommandLine();
-                 }
-                 break;
-             case Qt::Key_Left: 
-                 {
-                     _cursor_position--;
-                     if (_cursor_position < 0)
-                         _cursor_position = 0;
-                     else
-                         displayCommandLine();
-                 }
-                 break;
-             case Qt::Key_Return: 
-                 {
-                     if ( _command_line.isEmpty())
-                     {
-                         if ( _lru.isEmpty() )
-                             break;
-                         _command_line =  _lru.last();
-                         _cursor_position = _command_line.length();
-                     }
-                     debugger( DebuggerCommand( _command_line, DebuggerCommand::IMMEDIATE_COMMAND ) );
-                     _command_line.clear();
-                     _command_line_last.clear();
-                     _cursor_position=0;
-                     _lru_position = -1 ;
-                 }
-                 break;
-             case Qt::Key_C: 
-                 if (e->modifiers() == Qt::ControlModifier)
-                 {
-                     debuggerInterrupt();
-                     break;
-                 }
-             default:
-                 {
-                     QString command_line = _command_line.left(_cursor_position) + e->text() + _command_line.mid(_cursor_position);
-                     _command_line = command_line;
-                     _cursor_position++;
-                     displayCommandLine();
-                 }
-                 break;
-         }
-     }
-     else
-         QPlainTextEdit::keyPressEvent ( e );
-}
-
-void OCamlDebug::undisplayCommandLine()
-{
-    if ( !_command_line_last.isEmpty() )
+    switch (e->key())
     {
-        QTextCursor cur = textCursor();
-        cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
-        cur.movePosition(QTextCursor::PreviousCharacter, QTextCursor::KeepAnchor, _command_line_last.length()) ;
-        cur.removeSelectedText();
-        cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
-    }
-    _command_line_last=_command_line;
-}
-
-void OCamlDebug::displayCommandLine()
-{
-    undisplayCommandLine();
-    if ( !_command_line.isEmpty() )
+        case Qt::Key_PageDown: 
+        case Qt::Key_PageUp: 
+            QPlainTextEdit::keyPressEvent ( e );
+            return;
+        default:
+            break;
+    }
+    if ( e->matches( QKeySequence::Copy ) && textCursor().hasSelection() )
     {
-        QTextCursor cur = textCursor();
-        cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
-        cur.insertText(_command_line);
-        cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor );
-        int cursor_pos = _command_line.length() - _cursor_position;
-        if (cursor_pos>0)
-            cur.movePosition(QTextCursor::PreviousCharacter, QTextCursor::MoveAnchor, cursor_pos) ;
-        setTextCursor(cur);
-        ensureCursorVisible();
+        QPlainTextEdit::keyPressEvent ( e );
+        return;
     }
-    else
+    if ( _engine_p->isRunning() )
     {
-        QTextCursor cur = textCursor();
-        cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor );
-        setTextCursor(cur);
+        _input_p->lineEdit()->setFocus();
+        QCoreApplication::sendEvent( _input_p->lineEdit(), e );
     }
+    else
+        QPlainTextEdit::keyPressEvent ( e );
 }
 
 void OCamlDebug::keyReleaseEvent ( QKeyEvent * e )
@@ -310,459 +169,309 @@ void OCamlDebug::keyReleaseEvent ( QKeyEvent * e )
 void OCamlDebug::startProcess()
 {
     clear();
-    _current_port = findFreeServerPort( _current_port );
-    if ( _current_port == 0 )
-    {
-        QMessageBox::warning(this, tr("OCamlDebug server"),
-                tr("No free TCP port found between %1 and %2.").arg( _port_min ).arg( _port_max ),
-                QMessageBox::Ok );
-    }
-    else
-        Options::set_opt( "OCAMLDEBUG_PORT", _current_port );
     _time_info.clear();
-    _time = -1 ;
-    _command_queue.clear();
-    _command_queue << DebuggerCommand( "", DebuggerCommand::IMMEDIATE_COMMAND ) ;
-    QString program = _ocamldebug ;
-    QStringList args;
-    args 
-        << _arguments.ocamlDebugArguments() 
-        << _arguments.ocamlApp() 
-        << _arguments.ocamlAppArguments() 
-        ;
-
-    process_p =  new QProcess(this) ;
-    process_p->setProcessChannelMode(QProcess::MergedChannels);
-    connect ( process_p , SIGNAL( readyReadStandardOutput() ) , this , SLOT( receiveDataFromProcessStdOutput()) );
-    connect ( process_p , SIGNAL( readyReadStandardError() ) , this , SLOT( receiveDataFromProcessStdError()) );
-    process_p->start( program , args );
-    if ( ! process_p->waitForStarted())
+    if ( ! _engine_p->start() )
     {
-        QMessageBox::warning( this , tr( "Error Executing Command" ) , program );
         clear();
         return;
     }
+    if ( _engine_p->port() != 0 )
+        Options::set_opt( "OCAMLDEBUG_PORT", _engine_p->port() );
 
-    _ocamlrun_p->setArguments( _arguments );
-    debugger( DebuggerCommand( "set loadingmode manual", DebuggerCommand::HIDE_ALL_OUTPUT ) );
-    debugger( DebuggerCommand( "set socket 127.0.0.1:"+QString::number( _current_port ), DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-    debugger( DebuggerCommand( "goto 0", DebuggerCommand::HIDE_ALL_OUTPUT ) );
-    if ( QFile::exists( _ocamldebug_init_script ) )
-        debugger( DebuggerCommand( "source " + _ocamldebug_init_script, DebuggerCommand::SHOW_ALL_OUTPUT ) );
-    restoreBreakpoints();
-    emit debuggerStarted( true );
+    _ocamlrun_p->setArguments( _engine_p->arguments() );
     setEnabled( true );
 }
 
-void OCamlDebug::saveBreakpoints()
+void OCamlDebug::saveBreakpoints( const QStringList &breakpoint_commands )
 {
-    Options::set_opt( "BREAKPOINT_COMMANDS", generateBreakpointCommands() );
+    Options::set_opt( "BREAKPOINT_COMMANDS", breakpoint_commands );
 }
 
-void OCamlDebug::restoreBreakpoints()
+void OCamlDebug::saveLogpoints( const QStringList &logpoints )
 {
-    QStringList breakpoint_commands = Options::get_opt_strlst( "BREAKPOINT_COMMANDS" );
-    _breakpoints.clear();
-    saveBreakpoints();
-    emit breakPointList( _breakpoints );
+    Options::set_opt( "LOGPOINTS", logpoints );
+}
 
-    for (QStringList::const_iterator itCommand = breakpoint_commands.begin(); itCommand != breakpoint_commands.end(); ++itCommand )
-        debugger( DebuggerCommand( *itCommand, DebuggerCommand::HIDE_ALL_OUTPUT) );
+void OCamlDebug::saveBreakpointConditions( const QStringList &conditions )
+{
+    Options::set_opt( "BREAKPOINT_CONDITIONS", conditions );
+}
 
-    if ( _breakpoints.isEmpty() && !breakpoint_commands.isEmpty() )
-    { // if resetting breakpoints are not possible, do not save the new breakpoint list
-        Options::set_opt( "BREAKPOINT_COMMANDS", breakpoint_commands );
-    }
+void OCamlDebug::setBreakpointCondition( int id, const QString &condition, int hit_count )
+{
+    _engine_p->setBreakpointCondition( id, condition, hit_count );
 }
 
-QStringList OCamlDebug::generateBreakpointCommands() const
+void OCamlDebug::findValueChange( const QString &expression )
 {
-    QStringList breakpoint_commands ;
-    for (BreakPoints::const_iterator itBreakpoint = _breakpoints.begin() ; itBreakpoint != _breakpoints.end() ; ++itBreakpoint )
-    {
-        if ( itBreakpoint.value().command.isEmpty() )
-        {
-            QFileInfo sourceInfo( itBreakpoint.value().file );
-            QString module = sourceInfo.baseName();
-            module = module.toLower();
-            if (module.length() > 0)
-            {
-                module[0] = module[0].toUpper();
-                QFile f ( itBreakpoint.value().file );
-                if ( f.open( QFile::ReadOnly | QFile::Text ) )
-                {
-                    QString command = QString("break @ %1 %2 %3")
-                        .arg(module)
-                        .arg( QString::number( itBreakpoint.value().toLine  ) )
-                        .arg( QString::number( itBreakpoint.value().toColumn ) );
+    appendLog( tr( "Searching when '%1' got its current value...\n" ).arg( expression ) );
+    _value_search_p->findChange( expression );
+}
 
-                    breakpoint_commands << command;
-                }
-            }
-        }
-        else
-            breakpoint_commands << itBreakpoint.value().command ;
-    }
+void OCamlDebug::runUntilValueChange( const QString &expression )
+{
+    appendLog( tr( "Running until '%1' changes (Ctrl-C to stop)...\n" ).arg( expression ) );
+    _value_search_p->runUntilChange( expression );
+}
 
-    breakpoint_commands.removeDuplicates();
-    return breakpoint_commands;
+void OCamlDebug::valueSearchFinished( const QString &expression, bool found, int time )
+{
+    if ( found )
+        appendLog( tr( "'%1' changed at time %2 (%3 evaluations).\n" ).arg( expression ).arg( time ).arg( _value_search_p->evaluations() ) );
+    else if ( _value_search_p->mode() == ValueSearch::RUN_UNTIL_CHANGE )
+        appendLog( tr( "Stopped at time %1 before '%2' changed.\n" ).arg( time ).arg( expression ) );
+    else
+        appendLog( tr( "No change of '%1' found.\n" ).arg( expression ) );
 }
 
-void OCamlDebug::receiveDataFromProcessStdError()
+void OCamlDebug::setLogpoint( const QString &breakpoint_command, const QStringList &expressions )
 {
-    if (process_p)
-    {
-        process_p->setReadChannel(QProcess::StandardError);
-        readChannel();
-    }
+    _engine_p->setLogpoint( breakpoint_command, expressions );
+    if ( !_engine_p->breakpointCommands().contains( breakpoint_command ) )
+        debugger( DebuggerCommand( breakpoint_command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
 }
 
-void OCamlDebug::receiveDataFromProcessStdOutput()
+void OCamlDebug::engineError( const QString &title, const QString &message )
 {
-    if (process_p)
-    {
-        process_p->setReadChannel(QProcess::StandardOutput);
-        readChannel();
-    }
+    QMessageBox::warning( this, title, message, QMessageBox::Ok );
 }
 
-void OCamlDebug::readChannel()
+void OCamlDebug::startApplication( const QString &socket )
 {
-    QByteArray raw ;
-    while (process_p->canReadLine())
-    {
-        QByteArray raw = process_p->readLine();
-        appendText( raw );
-    }
-    raw = process_p->read(256);
-    appendText( raw );
+    _ocamlrun_p->startApplication( socket );
 }
 
-void OCamlDebug::appendText( const QByteArray &text )
+void OCamlDebug::engineTimeMarker( int time )
 {
-    bool display = true;
-    bool debugger_command = false;
-    DebuggerCommand::Option command_option = DebuggerCommand::SHOW_ALL_OUTPUT ;
-    QString command ;
-    if ( !_command_queue.isEmpty() )
-    {
-        command_option = _command_queue.first().option();
-        command = _command_queue.first().command();
-    }
-    QString data = QString::fromLatin1( text ).remove( '\r' );
-    bool command_completed = readyRx.indexIn( data ) >= 0;
-    if ( command_completed )
-    {
-        debugger_command = true;
-        data =  data.remove( readyRx );
-    }
+    _time_info[blockCount()] = time ;
+    UpdateScheduler::instance()->invoke( this, "updateDebugTimeAreaLayout" );
+}
 
-    if ( deleteBreakpointRx.indexIn(data) == 0 )
-    {
-        QString _id = deleteBreakpointRx.cap(1);
-        bool ok;
-        int id = _id.toInt(&ok);
-        if (ok)
-        {
-            debugger_command = true;
-            _breakpoints.remove( id );
-            emit breakPointList( _breakpoints );
-        }
-        saveBreakpoints();
-    }
-    else if ( hitBreakpointRx.indexIn(data) == 0 )
-    {
-        QList<int> ids ;
-        int pos = 0;
-        while ((pos = hitBreakpointIdRx.indexIn(data, pos)) != -1) 
-        {
-            QString sid = hitBreakpointIdRx.cap( 0 );
-            bool ok;
-            int id = sid.simplified().toInt( &ok );
-            if ( ok )
-                ids << id;
-            pos += hitBreakpointIdRx.matchedLength();
-        }
-        debugger_command = true;
-        _breakpoint_hits = ids;
-    }
-    else if ( newBreakpointRx.indexIn(data) == 0 )
-    {
-        BreakPoint breakpoint;
-        breakpoint.command = command;
-        QString _id = newBreakpointRx.cap(1);
-        breakpoint.file = newBreakpointRx.cap(2);
-        QString _line = newBreakpointRx.cap(3);
-        QString _from_char = newBreakpointRx.cap(4);
-        QString _to_char = newBreakpointRx.cap(5);
-        bool ok;
-        breakpoint.id = _id.toInt(&ok);
-        if (ok)
-            breakpoint.fromLine = _line.toInt(&ok);
-        breakpoint.toLine = breakpoint.fromLine;
-        if (ok)
-            breakpoint.fromColumn = _from_char.toInt(&ok);
-        if (ok)
-            breakpoint.toColumn = _to_char.toInt(&ok);
-        if (ok)
-        {
-            debugger_command = true;
-            _breakpoints[ breakpoint.id ] = breakpoint;
-            emit breakPointList( _breakpoints );
-        }
-        saveBreakpoints();
-    }
-    else if ( emacsLineInfoRx.indexIn(data) == 0 )
-    {
-        display = false ;
-        QString file = emacsLineInfoRx.cap(1);
-        QString start_char_str = emacsLineInfoRx.cap(2);
-        QString end_char_str = emacsLineInfoRx.cap(3);
-        QString instruction = emacsLineInfoRx.cap(4);
-        bool after = instruction == "after";
-
-        bool ok;
-        int start_char = start_char_str.toInt(&ok);
-        if (ok)
-        {
-            int end_char = end_char_str.toInt(&ok);
+void OCamlDebug::engineOutput( const QString &text )
+{
+    TRACE_SCOPE( "OCamlDebug::engineOutput" );
+    appendLog( text );
+    UpdateScheduler::instance()->invoke( this, "updateDebugTimeAreaLayout" );
+}
 
-            if (ok)
-            {
-                emit stopDebugging( file , start_char , end_char , after );
-                if ( _time >= 0)
-                {
-                    _time_info[blockCount()] = _time ;
-                    updateDebugTimeAreaWidth( 0 );
-                }
-            }
-        }
-        emit breakPointHit( _breakpoint_hits );
-        _breakpoint_hits.clear();
-    }
-    else if ( timeInfoRx.exactMatch(data) )
-    {
-        QString time = timeInfoRx.cap(1);
-        bool ok;
-        int t = time.toInt(&ok);
-        if ( ok )
-        {
-            debugger_command = true;
-            _time = t;
-        }
-    }
-    else if ( ocamlrunConnectionRx.exactMatch(data) )
-    {
-        debugger_command = true;
-        _ocamlrun_p->startApplication( _current_port );
-    }
-    else if ( emacsHaltInfoRx.exactMatch(data) )
+void OCamlDebug::engineCommandWritten( const QString &command, bool echo )
+{
+    if ( echo )
     {
-        display = false ;
-        emit stopDebugging( QString() , 0 , 0 , false);
-        if ( _time >= 0)
-        {
-            _time_info[blockCount()] = _time ;
-            updateDebugTimeAreaWidth( 0 );
-        }
-        emit breakPointHit( _breakpoint_hits );
-        _breakpoint_hits.clear();
-    }
-    else
-    {
-        for (QList<QRegExp>::iterator itRx = _debuggerOutputsRx.begin() ; itRx !=_debuggerOutputsRx.end() ; ++itRx )
-        {
-            if ( itRx->exactMatch(data) )
-                debugger_command = true;
-        }
+        saveLRU( command );
+        appendLog( command + '\n' );
     }
+}
+
+void OCamlDebug::appendLog( const QString &text )
+{
+    QTextCursor cur = textCursor();
+    cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
+    setTextCursor(cur);
+    cur.insertText(text);
+}
 
-    if ( display )
+void OCamlDebug::repaintDebugTimeArea()
+{
+    UpdateScheduler::instance()->update( debugTimeArea );
+}
+
+void OCamlDebug::updateDebugTimeAreaLayout()
+{
+    updateDebugTimeAreaWidth( 0 );
+}
+
+// Stops are reported to the panes once per display frame, with the latest location.
+// Command answers and breakpoint hits are delayed with them, so that the panes
+// see them in the engine order (e.g. the answer of 'up' after the stop before it).
+void OCamlDebug::postEvent( const PendingEvent &event )
+{
+    _pending_events.append( event );
+    UpdateScheduler::instance()->invoke( this, "emitPendingEvents" );
+}
+
+void OCamlDebug::engineStopDebugging( const QString &file, int start_char, int end_char, bool after )
+{
+    PendingEvent event;
+    event.kind = PendingEvent::STOP;
+    event.text = file;
+    event.start_char = start_char;
+    event.end_char = end_char;
+    event.after = after;
+    postEvent( event );
+}
+
+void OCamlDebug::engineFrameSelected( const QString &file, int start_char, int end_char, bool after )
+{
+    PendingEvent event;
+    event.kind = PendingEvent::FRAME;
+    event.text = file;
+    event.start_char = start_char;
+    event.end_char = end_char;
+    event.after = after;
+    postEvent( event );
+}
+
+void OCamlDebug::engineDebuggerCommand( const QString &command, const QString &result )
+{
+    PendingEvent event;
+    event.kind = PendingEvent::COMMAND;
+    event.text = command;
+    event.result = result;
+    postEvent( event );
+}
+
+void OCamlDebug::engineBreakPointHit( const QList<int> &hits )
+{
+    PendingEvent event;
+    event.kind = PendingEvent::HITS;
+    event.hits = hits;
+    postEvent( event );
+}
+
+// Only the last stop is emitted, and a frame selection only if no location
+// follows it: the panes did not request anything for the skipped ones, so the
+// answers received before them are still delivered in order.
+void OCamlDebug::emitPendingEvents()
+{
+    QList<PendingEvent> events;
+    events.swap( _pending_events );
+    int last_stop = -1, last_location = -1;
+    for ( int i = 0; i < events.count(); i++ )
     {
-        if ( !_command_queue.isEmpty() )
-            _command_queue.first().appendResult( data );
-
-        if ( 
-                 !debugger_command 
-                 && 
-                 command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT
-           )
-        {
-            if ( !data.isEmpty() )
-                if ( !_command_queue.isEmpty() )
-                    _command_queue.first().setOption( DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT );
-        }
-        if ( _time >= 0 && command_completed )
-            _time_info[blockCount()] = _time ;
-        if ( 
-                command_option == DebuggerCommand::SHOW_ALL_OUTPUT
-                ||
-                command_option == DebuggerCommand::IMMEDIATE_COMMAND
-                || 
-                ( 
-                 !debugger_command 
-                 && 
-                 (
-                  command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT
-                  ||
-                  command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT
-                 )
-                )
-                ||
-                ( 
-                 command_completed
-                 &&
-                 command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT
-                )
-           )
-        {
-            undisplayCommandLine();
-            QTextCursor cur = textCursor();
-            cur.movePosition(QTextCursor::End, QTextCursor::MoveAnchor) ;
-            setTextCursor(cur);
-            cur.insertText(text);
-            displayCommandLine();
-            updateDebugTimeAreaWidth( 0 );
-        }
-        debugTimeArea->repaint();
+        if ( events.at( i ).kind == PendingEvent::STOP )
+            last_stop = i;
+        if ( events.at( i ).kind == PendingEvent::STOP || events.at( i ).kind == PendingEvent::FRAME )
+            last_location = i;
     }
-    if ( command_completed )
+    for ( int i = 0; i < events.count(); i++ )
     {
-        if ( !_command_queue.isEmpty() )
+        const PendingEvent &event = events.at( i );
+        switch ( event.kind )
         {
-            QString command = _command_queue.first().command();
-            QString response = _command_queue.first().result();
-            emit debuggerCommand( command, response );
-            _command_queue.removeFirst();
+            case PendingEvent::STOP:
+                if ( i == last_stop )
+                {
+                    TRACE_SCOPE( "OCamlDebug::stopDebugging" );
+                    emit stopDebugging( event.text, event.start_char, event.end_char, event.after );
+                }
+                break;
+            case PendingEvent::FRAME:
+                if ( i == last_location )
+                    emit frameSelected( event.text, event.start_char, event.end_char, event.after );
+                break;
+            case PendingEvent::COMMAND:
+                emit debuggerCommand( event.text, event.result );
+                break;
+            case PendingEvent::HITS:
+                emit breakPointHit( event.hits );
+                break;
         }
-        processOneQueuedCommand();
     }
 }
 
 void OCamlDebug::debuggerInterrupt()
 {
+    if ( _value_search_p->isRunning() )
+    {
+        _value_search_p->cancel();
+        return;
+    }
 #if defined (Q_OS_WIN32)
     QMessageBox::information (this, tr("Information"), 
             tr("Ctrl-C is not supported on Windows.") );
 #else
-    int pid = process_p->pid();
-    ::kill( pid , SIGINT );
+    _engine_p->interrupt();
 #endif
     _ocamlrun_p->debuggerInterrupt() ;
 }
 
 void OCamlDebug::debugger( const DebuggerCommand &command )
 {
-    if ( command.option() == DebuggerCommand::IMMEDIATE_COMMAND )
-        _command_queue.clear();
-
-    bool empty_queue = _command_queue.isEmpty() ;
-    if ( _display_all_commands )
-    {
-        DebuggerCommand command_copy = command;
-        command_copy.setOption( DebuggerCommand::SHOW_ALL_OUTPUT );
-        _command_queue.append( command_copy );
-    }
-    else
-        _command_queue.append( command );
+    _engine_p->debugger( command );
+}
 
-    if ( empty_queue )
-        processOneQueuedCommand();
+void OCamlDebug::saveLRU(const QString &command)
+{
+    _input_p->addHistory( command );
 }
 
-void OCamlDebug::processOneQueuedCommand()
+void OCamlDebug::wheelEvent ( QWheelEvent * event )
 {
-    if ( process_p == NULL )
-        return ;
-    while ( !_command_queue.isEmpty() )
+    if ( _engine_p->isRunning() && ( event->modifiers() & ( Qt::ShiftModifier | Qt::ControlModifier ) ) )
     {
-        QString command = _command_queue.first().command();
-        if ( command.isEmpty() )
-            continue;
-        bool show_command =
-            _command_queue.first().option() == DebuggerCommand::SHOW_ALL_OUTPUT
-            ||
-            _command_queue.first().option() == DebuggerCommand::IMMEDIATE_COMMAND
-            ;
-        if( show_command )
-        {
-            saveLRU( command );
-            _command_line = command ;
-            _cursor_position = command.length();;
-            displayCommandLine();
-            _command_line += '\n';
-        }
-        process_p->write( (command+'\n').toLatin1() );
-        if( show_command )
+        // high resolution wheels send fractions of a 120 units notch
+        _wheel_delta += event->delta();
+        int notches = _wheel_delta / 120;
+        _wheel_delta -= notches * 120;
+        if ( notches != 0 )
         {
-            displayCommandLine();
-            _command_line.clear();
-            _command_line_last.clear();
-            _cursor_position=0;
+            QString command;
+            if ( ! ( event->modifiers() & Qt::ShiftModifier) )
+                command = notches > 0 ? "previous" : "next";
+            else if ( ! ( event->modifiers() & Qt::ControlModifier) )
+                command = notches > 0 ? "backstep" : "step";
+            else
+                command = notches > 0 ? "up" : "down";
+            debuggerStep( command, qAbs( notches ) );
         }
-        return;
+        event->ignore();
     }
-    debugTimeArea->repaint();
+    else
+        QPlainTextEdit::wheelEvent( event );
 }
 
-void OCamlDebug::saveLRU(const QString &command)
+static QString reverseStepCommand( const QString &command )
 {
-    if (!command.isEmpty())
+    static QMap<QString,QString> reverse;
+    if ( reverse.isEmpty() )
     {
-        _lru.removeAll(command);
-        _lru << command;
-        Options::set_opt("OCAMLDEBUG_COMMANDS", _lru);
+        reverse["step"] = "backstep";
+        reverse["backstep"] = "step";
+        reverse["next"] = "previous";
+        reverse["previous"] = "next";
+        reverse["up"] = "down";
+        reverse["down"] = "up";
     }
+    return reverse.value( command );
 }
 
-void OCamlDebug::wheelEvent ( QWheelEvent * event )
+// While the debugger is busy, consecutive stepping requests are accumulated
+// and sent as one counted command ('step 12') once the queue is empty.
+void OCamlDebug::debuggerStep( const QString &command, int count )
 {
-    if ( process_p )
+    QString forward = command;
+    if ( command == "backstep" || command == "previous" || command == "down" )
     {
-        if ( 
-                ( ! ( event->modifiers() & Qt::ShiftModifier) ) 
-                &&
-                ( event->modifiers() & Qt::ControlModifier)
-           )
-        {
-            if (event->delta() > 0 )
-                debugger( DebuggerCommand( "previous", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-            else if (event->delta() < 0 )
-                debugger( DebuggerCommand( "next", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-
-            event->ignore();
-        }
-        else if ( 
-                ( event->modifiers() & Qt::ShiftModifier)
-                &&
-                ( ! ( event->modifiers() & Qt::ControlModifier) )
-                )
-        {
-            if (event->delta() > 0 )
-                debugger( DebuggerCommand( "backstep", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-            else if (event->delta() < 0 )
-                debugger( DebuggerCommand( "step", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-
-            event->ignore();
-        }
-        else if ( 
-                ( event->modifiers() & Qt::ShiftModifier)
-                &&
-                ( event->modifiers() & Qt::ControlModifier) 
-                )
-        {
-            if (event->delta() > 0 )
-                debugger( DebuggerCommand( "up", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-            else if (event->delta() < 0 )
-                debugger( DebuggerCommand( "down", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
+        forward = reverseStepCommand( command );
+        count = -count;
+    }
+    if ( !_step_command.isEmpty() && _step_command != forward )
+        flushSteps();
+    _step_command = forward;
+    _step_count += count;
+    if ( _engine_p->isCommandQueueEmpty() )
+        flushSteps();
+}
 
-            event->ignore();
-        }
-        else
-            QPlainTextEdit::wheelEvent( event );
+void OCamlDebug::flushSteps()
+{
+    if ( _step_count != 0 && !_step_command.isEmpty() )
+    {
+        QString command = _step_count > 0 ? _step_command : reverseStepCommand( _step_command );
+        int count = qAbs( _step_count );
+        if ( count > 1 )
+            command += " " + QString::number( count );
+        debugger( DebuggerCommand( command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
     }
-    else
-        QPlainTextEdit::wheelEvent( event );
+    _step_command.clear();
+    _step_count = 0;
+}
+
+void OCamlDebug::engineCommandCompleted( const DebuggerCommand & )
+{
+    if ( _engine_p->isCommandQueueEmpty() )
+        flushSteps();
 }
 
 void OCamlDebug::contextMenuEvent(QContextMenuEvent *event)
@@ -770,12 +479,22 @@ void OCamlDebug::contextMenuEvent(QContextMenuEvent *event)
     QMenu *menu = createStandardContextMenu();
     QAction *displayCommandAct = new QAction( tr( "&Display all commands" ) , this );
     displayCommandAct->setCheckable( true );
-    displayCommandAct->setChecked( _display_all_commands );
+    displayCommandAct->setChecked( _engine_p->displayAllCommands() );
     connect( displayCommandAct, SIGNAL( triggered(bool) ), this, SLOT( displayAllCommands(bool) ) );
     menu->addAction( displayCommandAct );
+    QAction *warmStandbyAct = new QAction( tr( "&Keep a standby debugger ready" ) , this );
+    warmStandbyAct->setCheckable( true );
+    warmStandbyAct->setChecked( _engine_p->warmStandby() );
+    connect( warmStandbyAct, SIGNAL( triggered(bool) ), this, SLOT( warmStandby(bool) ) );
+    menu->addAction( warmStandbyAct );
+    QAction *stepFiltersAct = new QAction( tr( "Step &filters..." ) , this );
+    connect( stepFiltersAct, SIGNAL( triggered() ), this, SLOT( stepFilters() ) );
+    menu->addAction( stepFiltersAct );
     menu->exec(event->globalPos());
 
     delete displayCommandAct;
+    delete warmStandbyAct;
+    delete stepFiltersAct;
     delete menu;
 }
 
@@ -784,7 +503,9 @@ void OCamlDebug::resizeEvent( QResizeEvent *e )
     QPlainTextEdit::resizeEvent( e );
 
     QRect cr = contentsRect();
-    debugTimeArea->setGeometry( QRect( cr.left(), cr.top(), debugTimeAreaWidth(), cr.height() ) );
+    int input_height = _input_p->sizeHint().height();
+    debugTimeArea->setGeometry( QRect( cr.left(), cr.top(), debugTimeAreaWidth(), cr.height() - input_height ) );
+    _input_p->setGeometry( QRect( cr.left(), viewport()->geometry().bottom() + 1, debugTimeAreaWidth() + viewport()->width(), input_height ) );
 }
 
 void OCamlDebug::updateDebugTimeArea( const QRect &rect, int dy )
@@ -801,7 +522,7 @@ void OCamlDebug::updateDebugTimeArea( const QRect &rect, int dy )
 
 void OCamlDebug::updateDebugTimeAreaWidth( int /* newBlockCount */ )
 {
-    setViewportMargins( debugTimeAreaWidth(), 0, 0, 0 );
+    setViewportMargins( debugTimeAreaWidth(), 0, 0, _input_p ? _input_p->sizeHint().height() : 0 );
 }
 
 int OCamlDebug::debugTimeAreaWidth()
@@ -845,7 +566,7 @@ void OCamlDebug::debugTimeAreaPaintEvent( QPaintEvent *event )
             }
             else
             {
-                if ( !_command_queue.isEmpty() && blockNumber == blockCount()-1 )
+                if ( !_engine_p->isCommandQueueEmpty() && blockNumber == blockCount()-1 )
                 {
                     painter.setPen( Qt::blue );
                     painter.drawText( 0, top, debugTimeArea->width(), fontMetrics().height(),
@@ -877,28 +598,6 @@ void OCamlDebug::debugTimeAreaPaintEvent( QPaintEvent *event )
     }
 }
 
-int OCamlDebug::findFreeServerPort( int port ) const
-{
-    int offset = 0;
-    int free_port;
-    do
-    {
-        offset++;
-        free_port = port + offset;
-        QTcpServer tcp_server;
-        if ( tcp_server.listen( QHostAddress( "127.0.0.1" ), free_port ) )
-        {
-            tcp_server.close();
-            return free_port;
-        }
-        if ( free_port > _port_max )
-            free_port = _port_min ;
-    }
-    while ( port != free_port );
-
-    return 0;
-}
-
 OCamlDebugTime::OCamlDebugTime( OCamlDebug *d ) : QWidget( d )
 {
     debugger = d;
@@ -957,6 +656,235 @@ bool OCamlDebugTime::event(QEvent *event)
 
 void OCamlDebug::displayAllCommands( bool b )
 {
-    _display_all_commands = b;
+    _engine_p->setDisplayAllCommands( b );
     Options::set_opt( "DISPLAY_ALL_OCAMLDEBUG_COMMANDS", b );
 }
+
+void OCamlDebug::warmStandby( bool b )
+{
+    _engine_p->setWarmStandby( b );
+    Options::set_opt( "OCAMLDEBUG_WARM_STANDBY", b );
+}
+
+void OCamlDebug::stepFilters()
+{
+    bool ok;
+    QString text = QInputDialog::getText( this, tr( "Step Filters" ),
+            tr( "Modules or files skipped when stepping (wildcards, separated by spaces):" ), QLineEdit::Normal,
+            _engine_p->stepFilters().join( " " ), &ok );
+    if ( ok )
+    {
+        QStringList filters = text.split( ' ', QString::SkipEmptyParts );
+        _engine_p->setStepFilters( filters );
+        Options::set_opt( "OCAMLDEBUG_STEP_FILTERS", filters );
+    }
+}
+
+OCamlDebugInput::OCamlDebugInput( OCamlDebug *d ) : QWidget( d )
+{
+    debugger = d;
+    _prompt_p = new QLabel( this );
+    _line_edit_p = new QLineEdit( this );
+    _line_edit_p->setFrame( false );
+    _line_edit_p->installEventFilter( this );
+    QHBoxLayout *layout_p = new QHBoxLayout( this );
+    layout_p->setContentsMargins( 3, 0, 0, 0 );
+    layout_p->setSpacing( 3 );
+    layout_p->addWidget( _prompt_p );
+    layout_p->addWidget( _line_edit_p );
+    setAutoFillBackground( true );
+
+    _history.setCapacity( Options::get_opt_int( "OCAMLDEBUG_HISTORY_SIZE", 1000 ) );
+    _history.fromStringList( Options::get_opt_strlst ("OCAMLDEBUG_COMMANDS") );
+    _history_position = -1;
+    _search_mode = false;
+    _search_failed = false;
+    _search_position = -1;
+    _prompt_p->setText( "(ocd)" );
+}
+
+OCamlDebugInput::~OCamlDebugInput()
+{
+    Options::release_opt_lazy( "OCAMLDEBUG_COMMANDS" );
+}
+
+QSize OCamlDebugInput::sizeHint() const
+{
+    return QSize( 0, _line_edit_p->sizeHint().height() );
+}
+
+void OCamlDebugInput::addHistory( const QString &command )
+{
+    if ( _history.add( command ) )
+        _history_position = -1; // positions are renumbered
+    Options::set_opt_lazy( "OCAMLDEBUG_COMMANDS", this );
+}
+
+// The history is only converted when the options are written
+QVariant OCamlDebugInput::optionValue() const
+{
+    return _history.toStringList();
+}
+
+void OCamlDebugInput::setCommandLine( const QString &command )
+{
+    _line_edit_p->setText( command );
+    _line_edit_p->end( false );
+}
+
+bool OCamlDebugInput::eventFilter( QObject *object_p, QEvent *event )
+{
+    if ( object_p == _line_edit_p && event->type() == QEvent::KeyPress )
+        return keyPress( static_cast<QKeyEvent*>( event ) );
+    return QWidget::eventFilter( object_p, event );
+}
+
+// Returns true if the key is consumed, otherwise the line edit processes it
+bool OCamlDebugInput::keyPress( QKeyEvent *e )
+{
+    if ( _search_mode || ( e->key() == Qt::Key_R && e->modifiers() == Qt::ControlModifier ) )
+    {
+        if ( searchKeyPress( e ) )
+            return true;
+    }
+    switch ( e->key() )
+    {
+        case Qt::Key_PageDown: 
+        case Qt::Key_PageUp: 
+            QCoreApplication::sendEvent( debugger->verticalScrollBar(), e );
+            return true;
+        case Qt::Key_Up: 
+            {
+                int position = _history.previous( _history_position < 0 ? _history.end() : _history_position );
+                if ( position < 0 )
+                    return true;
+
+                if ( _history_position < 0 )
+                    _command_line_backup = _line_edit_p->text();
+                _history_position = position;
+                setCommandLine( _history.at( _history_position ) );
+            }
+            return true;
+        case Qt::Key_Down: 
+            {
+                if ( _history_position < 0 )
+                    return true;
+                _history_position = _history.next( _history_position );
+                if ( _history_position < 0 )
+                    setCommandLine( _command_line_backup );
+                else
+                    setCommandLine( _history.at( _history_position ) );
+            }
+            return true;
+        case Qt::Key_Tab: 
+            {
+                QString completion = _history.complete( _line_edit_p->text() );
+                if ( !completion.isEmpty() )
+                    setCommandLine( completion );
+            }
+            return true;
+        case Qt::Key_Return: 
+        case Qt::Key_Enter: 
+            {
+                QString command = _line_edit_p->text();
+                if ( command.isEmpty() )
+                {
+                    if ( _history.isEmpty() )
+                        return true;
+                    command = _history.last();
+                }
+                debugger->debugger( DebuggerCommand( command, DebuggerCommand::IMMEDIATE_COMMAND ) );
+                _line_edit_p->clear();
+                _history_position = -1 ;
+            }
+            return true;
+        case Qt::Key_C: 
+            if ( e->modifiers() == Qt::ControlModifier && !_line_edit_p->hasSelectedText() )
+            {
+                debugger->debuggerInterrupt();
+                return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+// Reverse incremental search in the history (Ctrl-R).
+// Returns false if the key ends the search and must be processed as usual.
+bool OCamlDebugInput::searchKeyPress( QKeyEvent *e )
+{
+    if ( e->key() == Qt::Key_R && e->modifiers() == Qt::ControlModifier )
+    {
+        if ( !_search_mode )
+        {
+            _search_mode = true;
+            _search_text.clear();
+            _search_match.clear();
+            _search_failed = false;
+            _search_position = _history.end();
+            _command_line_backup = _line_edit_p->text();
+        }
+        else if ( !_search_text.isEmpty() )
+            searchHistory( _search_position );
+        displaySearch();
+        return true;
+    }
+
+    if ( e->key() == Qt::Key_Escape || ( e->key() == Qt::Key_G && e->modifiers() == Qt::ControlModifier ) )
+    {
+        endSearch( _command_line_backup );
+        return true;
+    }
+
+    if ( e->key() == Qt::Key_Backspace )
+    {
+        _search_text.chop( 1 );
+        _search_match.clear();
+        _search_failed = false;
+        _search_position = _history.end();
+        if ( !_search_text.isEmpty() )
+            searchHistory( _search_position );
+        displaySearch();
+        return true;
+    }
+
+    QString text = e->text();
+    if ( e->key() != Qt::Key_Return && e->key() != Qt::Key_Enter && e->key() != Qt::Key_Tab && !text.isEmpty() && text.at( 0 ).isPrint() )
+    {
+        _search_text += text;
+        // the current match is kept while it contains the text
+        searchHistory( _search_match.isEmpty() ? _history.end() : _search_position + 1 );
+        displaySearch();
+        return true;
+    }
+
+    // any other key accepts the match
+    endSearch( _search_match.isEmpty() ? _command_line_backup : _search_match );
+    return false;
+}
+
+void OCamlDebugInput::searchHistory( int before )
+{
+    int position = _history.searchBackward( _search_text, before );
+    _search_failed = position < 0;
+    if ( !_search_failed )
+    {
+        _search_position = position;
+        _search_match = _history.at( position );
+    }
+}
+
+void OCamlDebugInput::displaySearch()
+{
+    QString prompt = _search_failed ? tr( "(failed reverse-i-search)" ) : tr( "(reverse-i-search)" );
+    _prompt_p->setText( QString( "%1`%2':" ).arg( prompt ).arg( _search_text ) );
+    setCommandLine( _search_match );
+}
+
+void OCamlDebugInput::endSearch( const QString &command )
+{
+    _search_mode = false;
+    _prompt_p->setText( "(ocd)" );
+    setCommandLine( command );
+}
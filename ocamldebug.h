@@ -2,18 +2,23 @@
 #define OCAMLDEBUG_H
 
 #include <QPlainTextEdit>
-#include <QProcess>
+#include <QLineEdit>
+#include <QLabel>
 #include <QString>
 #include <QStringList>
 #include <QTextStream>
 #include "ocamldebughighlighter.h"
-#include "filesystemwatcher.h"
+#include "ocamldebugengine.h"
 #include "breakpoint.h"
 #include "debuggercommand.h"
+#include "commandhistory.h"
 #include "arguments.h"
+#include "options.h"
 
 class OCamlDebugTime;
+class OCamlDebugInput;
 class OCamlRun;
+class ValueSearch;
 
 class OCamlDebug : public QPlainTextEdit
 {
@@ -27,8 +32,9 @@ public:
     int debugTimeAreaWidth();
     void debugTimeAreaPaintEvent( QPaintEvent *event );
     const QMap<int,int> & timeInfo() const { return _time_info; }
-    void setInitializationScript( const QString &s ) { _ocamldebug_init_script =s ; }
-    const BreakPoints & breakpoints() const { return _breakpoints; }
+    void setInitializationScript( const QString &s ) { _engine_p->setInitializationScript( s ); }
+    const BreakPoints & breakpoints() const { return _engine_p->breakpoints(); }
+    OCamlDebugEngine * engine() const { return _engine_p; }
 
 protected:
     void closeEvent(QCloseEvent *event);
@@ -42,65 +48,83 @@ public slots:
     void stopDebug();
     void debuggerInterrupt();
     void debugger( const DebuggerCommand & command );
+    void debuggerStep( const QString &command, int count = 1 );
+    void setLogpoint( const QString &breakpoint_command, const QStringList &expressions );
+    void setBreakpointCondition( int id, const QString &condition, int hit_count );
+    void findValueChange( const QString &expression );
+    void runUntilValueChange( const QString &expression );
     void updateDebugTimeAreaWidth(int newBlockCount);
     void updateDebugTimeArea(const QRect &, int);
 
 private slots:
     void displayAllCommands(bool) ;
-    void receiveDataFromProcessStdOutput();
-    void receiveDataFromProcessStdError();
+    void warmStandby(bool) ;
+    void stepFilters() ;
     void fileChanged ( );
+    void engineOutput( const QString & );
+    void engineCommandWritten( const QString &, bool );
+    void engineTimeMarker( int );
+    void engineError( const QString &, const QString & );
+    void startApplication( const QString & );
+    void saveBreakpoints( const QStringList & );
+    void saveLogpoints( const QStringList & );
+    void saveBreakpointConditions( const QStringList & );
+    void valueSearchFinished( const QString &expression, bool found, int time );
+    void repaintDebugTimeArea();
+    void updateDebugTimeAreaLayout();
+    void engineStopDebugging( const QString &, int , int , bool );
+    void engineFrameSelected( const QString &, int , int , bool );
+    void engineDebuggerCommand( const QString &, const QString & );
+    void engineBreakPointHit( const QList<int> & );
+    void emitPendingEvents();
+    void engineCommandCompleted( const DebuggerCommand & );
 
 signals:
     void stopDebugging( const QString &, int , int , bool);
+    void frameSelected( const QString &, int , int , bool);
     void breakPointList( const BreakPoints & );
     void breakPointHit( const QList<int> & );
     void debuggerStarted( bool );
     void debuggerCommand( const QString & command, const QString & result );
+    void logpointHit( int id, int time, const QString &value );
 private:
-    void restoreBreakpoints();
-    void saveBreakpoints();
-    void processOneQueuedCommand();
     void contextMenuEvent(QContextMenuEvent *event);
     void wheelEvent ( QWheelEvent * event );
     void saveLRU(const QString &command);
+    void appendLog( const QString & );
+    void flushSteps();
     void startProcess( );
     void clear();
-    void readChannel();
-    void appendText(const QByteArray &);
     OCamlDebugHighlighter *highlighter;
-    QProcess *process_p;
-    QRegExp emacsLineInfoRx ;
-    BreakPoints _breakpoints;
-    QRegExp readyRx ;
-    QRegExp deleteBreakpointRx ;
-    QRegExp hitBreakpointRx ;
-    QRegExp hitBreakpointIdRx ;
-    QRegExp newBreakpointRx ;
-    QRegExp emacsHaltInfoRx ;
-    QRegExp timeInfoRx ;
-    QRegExp ocamlrunConnectionRx ;
-    QList<QRegExp> _debuggerOutputsRx;
-    QString _ocamldebug, _ocamldebug_init_script;
-    Arguments _arguments;
-    QString _command_line,_command_line_last,_command_line_backup;
+    OCamlDebugEngine *_engine_p;
+    ValueSearch *_value_search_p;
     QMap<int,int> _time_info;
-    int _time;
-    int _cursor_position;
-    int _lru_position;
-    void displayCommandLine();
-    void undisplayCommandLine();
-    QStringList _lru;
-    FileSystemWatcher *file_watch_p;
-    QList<DebuggerCommand> _command_queue;
+    // Engine notifications delivered to the panes once per display frame,
+    // in their original order
+    struct PendingEvent
+    {
+        enum Kind
+        {
+            STOP,
+            FRAME,
+            COMMAND,
+            HITS
+        };
+        Kind kind;
+        QString text; // file of a stop or frame, command
+        QString result;
+        int start_char, end_char;
+        bool after;
+        QList<int> hits;
+    };
+    QList<PendingEvent> _pending_events;
+    void postEvent( const PendingEvent & );
     OCamlDebugTime *debugTimeArea;
-    QList<int> _breakpoint_hits;
-    QStringList generateBreakpointCommands() const;
+    OCamlDebugInput *_input_p;
     OCamlRun *_ocamlrun_p;
-    const int _port_min, _port_max;
-    int _current_port;
-    int findFreeServerPort( int ) const;
-    bool _display_all_commands;
+    QString _step_command;
+    int _step_count;
+    int _wheel_delta;
 };
 
 class OCamlDebugTime : public QWidget
@@ -118,4 +142,40 @@ class OCamlDebugTime : public QWidget
         OCamlDebug *debugger;
 };
 
+// Command line below the log, with its own history and completion:
+// typing never modifies the log document.
+class OCamlDebugInput : public QWidget, public OptionProvider
+{
+    public:
+        OCamlDebugInput( OCamlDebug *d ) ;
+        ~OCamlDebugInput();
+        QSize sizeHint() const;
+        QLineEdit *lineEdit() const { return _line_edit_p; }
+        void addHistory( const QString &command );
+        QVariant optionValue() const;
+
+    protected:
+        bool eventFilter( QObject *object_p, QEvent *event );
+
+    private:
+        bool keyPress( QKeyEvent *e );
+        bool searchKeyPress( QKeyEvent *e );
+        void searchHistory( int before );
+        void displaySearch();
+        void endSearch( const QString &command );
+        void setCommandLine( const QString &command );
+
+        OCamlDebug *debugger;
+        QLabel *_prompt_p;
+        QLineEdit *_line_edit_p;
+        CommandHistory _history;
+        int _history_position;
+        QString _command_line_backup;
+        bool _search_mode;
+        bool _search_failed;
+        QString _search_text;
+        QString _search_match;
+        int _search_position;
+};
+
 #endif
@@ -0,0 +1,1046 @@
+#include <QtDebug>
+#include <QTcpServer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include "ocamldebugengine.h"
+#include "tracer.h"
+#include "moduleindex.h"
+#include "debuggerreply.h"
+#if !defined(Q_OS_WIN32)
+#include <sys/types.h>
+#include <signal.h>
+#endif
+
+
+OCamlDebugEngine::OCamlDebugEngine( QObject *parent_p, const QString &ocamldebug, const Arguments &arguments, const QString & init_script ) : QObject(parent_p),
+    emacsLineInfoRx("^\\x001A\\x001AM([^:].[^:]*):([^:]*):([^:]*):([^:\\n]*)\\n*$") ,
+    readyRx("^\\(ocd\\) *") ,
+    deleteBreakpointRx("^Removed breakpoint ([0-9]+) at [0-9]+ *: .*$"),
+    hitBreakpointRx("^Breakpoints? :( [0-9]+)+ ?\\n?$"),
+    hitBreakpointIdRx("( [0-9]+)"),
+    newBreakpointRx("^Breakpoint ([0-9]+) at [0-9]+ *: file ([^,]*), line ([0-9]+), characters ([0-9]+)-([0-9]+).*$"),
+    emacsHaltInfoRx("^\\x001A\\x001AH.*$"),
+    timeInfoRx("^Time *: *([0-9]+)( - pc *: *([0-9]+) - .*)?\\n?$"),
+    ocamlrunConnectionRx("^Waiting for connection\\.\\.\\.\\(the socket is ([^)]+)\\)\\n?$"),
+    _ocamldebug_init_script( init_script ),
+    _arguments( arguments ),
+    _breakpoint_index( NULL ),
+    _time( -1 ),
+    _port_min( 18000 ),
+    _port_max( 18999 )
+{
+    _current_port = _port_min;
+    _display_all_commands = false;
+    _unix_socket = true;
+    _written_commands = 0;
+    _step_filter_count = 0;
+    _stops_reported = true;
+    _breakpoints_restored = false;
+    _debuggerOutputsRx.append( QRegExp( "^No such frame\\.\\n?$" ) );
+    _debuggerOutputsRx.append( QRegExp( "^#([0-9]+)  *Pc *: *[0-9]+ .*$" ) );
+    _debuggerOutputsRx.append( QRegExp( "^Loading program\\.\\.\\.[\\n ]+$" ) );
+    _debuggerOutputsRx.append( QRegExp( "^done\\.[\\n ]+$" ) );
+
+    process_p = NULL;
+    file_watch_p = NULL;
+    _standby_p = NULL;
+    _standby_port = 0;
+    _warm_standby = false;
+    _clock.start();
+    _settle_size = -1;
+    _settle_timer.setSingleShot( true );
+    _settle_timer.setInterval( 500 );
+    connect( &_settle_timer, SIGNAL( timeout() ), this, SLOT( applicationFileSettled() ) );
+    setArguments( _arguments );
+    setOCamlDebug( ocamldebug );
+}
+
+OCamlDebugEngine::~OCamlDebugEngine()
+{
+    stop();
+    discardStandbyProcess();
+    if ( file_watch_p )
+        delete file_watch_p;
+}
+
+void OCamlDebugEngine::setOCamlDebug( const QString &ocamldebug )
+{
+    _ocamldebug = ocamldebug ;
+    discardStandbyProcess();
+}
+
+void OCamlDebugEngine::setArguments( const Arguments &arguments )
+{
+    _arguments = arguments ;
+    discardStandbyProcess();
+    QString ocamlapp = _arguments.ocamlApp() ;
+    if ( file_watch_p )
+        delete file_watch_p;
+    file_watch_p = new FileSystemWatcher( ocamlapp );
+    connect ( file_watch_p , SIGNAL( fileChanged ( ) ) , this , SLOT( applicationFileChanged () ) , Qt::QueuedConnection );
+    _settle_timer.stop();
+}
+
+// Patterns are wildcards matched against the module name and the file name
+// of a stop, e.g. 'Stdlib*' or '*/.opam/*'
+void OCamlDebugEngine::setStepFilters( const QStringList &filters )
+{
+    _step_filters = filters;
+    _step_filters_rx.clear();
+    for ( QStringList::const_iterator itFilter = filters.begin(); itFilter != filters.end(); ++itFilter )
+    {
+        QString filter = itFilter->trimmed();
+        if ( !filter.isEmpty() )
+            _step_filters_rx.append( QRegExp( filter, Qt::CaseSensitive, QRegExp::Wildcard ) );
+    }
+}
+
+bool OCamlDebugEngine::isStepFiltered( const QString &file ) const
+{
+    if ( _step_filters_rx.isEmpty() )
+        return false;
+    QString module = ModuleIndex::moduleName( file );
+    for ( QList<QRegExp>::const_iterator itRx = _step_filters_rx.begin(); itRx != _step_filters_rx.end(); ++itRx )
+    {
+        if ( itRx->exactMatch( module ) || itRx->exactMatch( file ) )
+            return true;
+    }
+    return false;
+}
+
+// Command resuming the execution after a breakpoint hit by 'command',
+// or an empty string if the stop has to be reported
+QString OCamlDebugEngine::breakpointResumeCommand( const QString &command )
+{
+    QString kind = command.section( ' ', 0, 0, QString::SectionSkipEmpty );
+    if ( kind == "run" || kind == "r" )
+        return "run";
+    if ( kind == "reverse" || kind == "rev" )
+        return "reverse";
+    return QString();
+}
+
+void OCamlDebugEngine::queueHiddenCommand( int position, const QString &command, DebuggerCommand::Option option )
+{
+    DebuggerCommand hidden_command( command, option );
+    hidden_command.setEnqueued( _clock.nsecsElapsed() );
+    _command_queue.insert( position, hidden_command );
+}
+
+// Queues the prints of the logpoints hit and the evaluations of the conditions,
+// ahead of any command not yet written.
+// Returns true if the stop is not reported now: the execution is resumed or
+// the decision is deferred until the conditions are printed.
+bool OCamlDebugEngine::breakpointsHit( const QString &command, const QString &file, int start_char, int end_char, bool after )
+{
+    bool stop = false;
+    QList<int> conditions;
+    int position = qMax( 1, _written_commands );
+    for ( QList<int>::const_iterator itId = _breakpoint_hits.begin(); itId != _breakpoint_hits.end(); ++itId )
+    {
+        BreakPoints::const_iterator itBreakpoint = _breakpoints.constFind( *itId );
+        if ( itBreakpoint == _breakpoints.constEnd() )
+            stop = true;
+        else if ( !itBreakpoint->log.isEmpty() )
+        {
+            LogpointPrint print;
+            print.id = *itId;
+            print.time = _time;
+            print.command = "print " + itBreakpoint->log.join( " " );
+            _logpoint_prints.append( print );
+            queueHiddenCommand( position++, print.command, DebuggerCommand::HIDE_ALL_OUTPUT );
+        }
+        else if ( !itBreakpoint->condition.isEmpty() )
+            conditions << *itId;
+        else if ( ++_hit_counters[ *itId ] >= itBreakpoint->hitCount )
+            stop = true;
+    }
+    QString resume_command = breakpointResumeCommand( command );
+    if ( stop || resume_command.isEmpty() )
+        return false;
+    if ( conditions.isEmpty() )
+    {
+        queueHiddenCommand( position, resume_command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT );
+        return true;
+    }
+
+    _deferred_stop.file = file;
+    _deferred_stop.start_char = start_char;
+    _deferred_stop.end_char = end_char;
+    _deferred_stop.after = after;
+    _deferred_stop.hits = _breakpoint_hits;
+    _deferred_stop.resume_command = resume_command;
+    _deferred_stop.evaluations = conditions.count();
+    _deferred_stop.stop = false;
+    for ( QList<int>::const_iterator itId = conditions.begin(); itId != conditions.end(); ++itId )
+    {
+        ConditionPrint print;
+        print.id = *itId;
+        print.condition = _breakpoints.value( *itId ).condition;
+        print.command = "print " + DebuggerReply::conditionExpression( print.condition );
+        _condition_prints.append( print );
+        queueHiddenCommand( position++, print.command, DebuggerCommand::HIDE_ALL_OUTPUT );
+    }
+    return true;
+}
+
+// Called once the condition printed first is answered: the deferred stop is
+// reported when a condition holds for the requested number of hits, otherwise
+// the execution is resumed once all conditions are evaluated.
+void OCamlDebugEngine::conditionEvaluated( const QString &result )
+{
+    ConditionPrint print = _condition_prints.takeFirst();
+    BreakPoints::const_iterator itBreakpoint = _breakpoints.constFind( print.id );
+    if ( itBreakpoint != _breakpoints.constEnd()
+            && DebuggerReply::evaluateCondition( print.condition, result )
+            && ++_hit_counters[ print.id ] >= itBreakpoint->hitCount )
+        _deferred_stop.stop = true;
+
+    if ( --_deferred_stop.evaluations > 0 )
+        return;
+    if ( _deferred_stop.stop )
+    {
+        TRACE_SCOPE( "OCamlDebugEngine::stopDebugging" );
+        emit stopDebugging( _deferred_stop.file , _deferred_stop.start_char , _deferred_stop.end_char , _deferred_stop.after );
+        if ( _time >= 0)
+            emit timeMarker( _time );
+        emit breakPointHit( _deferred_stop.hits );
+    }
+    else
+        queueHiddenCommand( _written_commands, _deferred_stop.resume_command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT );
+}
+
+// Commands selecting a frame, abbreviated as OCamlStack recognizes them
+bool OCamlDebugEngine::isFrameCommand( const QString &command )
+{
+    QString kind = command.section( ' ', 0, 0, QString::SectionSkipEmpty );
+    return kind == "up" || kind == "u" || kind == "down" || kind == "do" || kind == "frame" || kind == "fr";
+}
+
+// Command moving on after a stop in a filtered module produced by 'command',
+// or an empty string if stops of this command are never filtered.
+// The filtered code is stepped through rather than finished, so that the user
+// callbacks of a library function (List.iter f l...) are still entered.
+QString OCamlDebugEngine::stepFilterCommand( const QString &command )
+{
+    QString kind = command.section( ' ', 0, 0, QString::SectionSkipEmpty );
+    if ( kind == "step" || kind == "s" || kind == "next" || kind == "n" || kind == "finish" )
+        return "step";
+    if ( kind == "backstep" || kind == "bs" || kind == "previous" || kind == "prev" || kind == "start" )
+        return "backstep";
+    return QString();
+}
+
+// A rebuild writes the bytecode in several steps: wait until its size and
+// modification time are stable before reporting a single modification.
+void OCamlDebugEngine::applicationFileChanged()
+{
+    QFileInfo info( _arguments.ocamlApp() );
+    _settle_size = info.exists() ? info.size() : -1;
+    _settle_modified = info.lastModified();
+    _settle_timer.start();
+}
+
+void OCamlDebugEngine::applicationFileSettled()
+{
+    QFileInfo info( _arguments.ocamlApp() );
+    if ( !info.exists() )
+    {
+        _settle_size = -1;
+        return; // the file watcher notifies when it is created again
+    }
+    if ( info.size() != _settle_size || info.lastModified() != _settle_modified )
+    {
+        applicationFileChanged();
+        return;
+    }
+    emit applicationModified();
+}
+
+void OCamlDebugEngine::stop()
+{
+    if ( process_p )
+    {
+        process_p->terminate();
+        if (process_p->waitForFinished( 1000 ) )
+            process_p->kill();
+        process_p->close();
+        delete process_p;
+        process_p = NULL;
+    }
+    if ( !_socket.isEmpty() && !_socket.contains( ':' ) )
+        QFile::remove( _socket );
+    _socket.clear();
+}
+
+// Unix domain socket in the private runtime directory, or an empty string if not available
+QString OCamlDebugEngine::unixSocketPath() const
+{
+#if defined(Q_OS_UNIX)
+    if ( !_unix_socket )
+        return QString();
+    QString runtime_dir = QStandardPaths::writableLocation( QStandardPaths::RuntimeLocation );
+    if ( runtime_dir.isEmpty() )
+        return QString();
+    static int counter = 0;
+    QString path = QString( "%1/oqamldebug-%2-%3.sock" )
+        .arg( runtime_dir )
+        .arg( QCoreApplication::applicationPid() )
+        .arg( counter++ );
+    // sun_path of sockaddr_un
+    if ( path.toLocal8Bit().length() >= 104 )
+        return QString();
+    return path;
+#else
+    return QString();
+#endif
+}
+
+bool OCamlDebugEngine::start()
+{
+    stop();
+    _time = -1 ;
+    _command_queue.clear();
+    _logpoint_prints.clear();
+    _condition_prints.clear();
+    _hit_counters.clear();
+    _stops_reported = true;
+    // the first answer is the banner of ocamldebug
+    _command_queue << DebuggerCommand( "", DebuggerCommand::IMMEDIATE_COMMAND ) ;
+    _written_commands = 1;
+
+    if ( takeStandbyProcess() )
+    {
+        // the banner is already buffered and the prelude already written:
+        // their answers ("(ocd) (ocd) (ocd) ") complete the queued commands
+        QList<DebuggerCommand> prelude = preludeCommands( _socket );
+        for ( QList<DebuggerCommand>::iterator itCommand = prelude.begin(); itCommand != prelude.end(); ++itCommand )
+        {
+            itCommand->setEnqueued( _clock.nsecsElapsed() );
+            itCommand->setWritten( _clock.nsecsElapsed() );
+            emit commandWritten( itCommand->command(), false );
+            _command_queue << *itCommand;
+            _written_commands++;
+        }
+        connect ( process_p , SIGNAL( readyReadStandardOutput() ) , this , SLOT( receiveDataFromProcessStdOutput()) );
+        connect ( process_p , SIGNAL( readyReadStandardError() ) , this , SLOT( receiveDataFromProcessStdError()) );
+        receiveDataFromProcessStdOutput();
+    }
+    else
+    {
+        int port = _current_port;
+        _socket = newSocket( port );
+        if ( _socket.isEmpty() )
+        {
+            emit error( tr("OCamlDebug server"),
+                    tr("No free TCP port found between %1 and %2.").arg( _port_min ).arg( _port_max ) );
+            return false;
+        }
+        _current_port = port;
+
+        process_p = spawnProcess();
+        connect ( process_p , SIGNAL( readyReadStandardOutput() ) , this , SLOT( receiveDataFromProcessStdOutput()) );
+        connect ( process_p , SIGNAL( readyReadStandardError() ) , this , SLOT( receiveDataFromProcessStdError()) );
+        if ( ! process_p->waitForStarted())
+        {
+            emit error( tr( "Error Executing Command" ) , _ocamldebug );
+            stop();
+            return false;
+        }
+
+        QList<DebuggerCommand> prelude = preludeCommands( _socket );
+        for ( QList<DebuggerCommand>::const_iterator itCommand = prelude.begin(); itCommand != prelude.end(); ++itCommand )
+            debugger( *itCommand );
+    }
+
+    debugger( DebuggerCommand( "goto 0", DebuggerCommand::HIDE_ALL_OUTPUT ) );
+    if ( QFile::exists( _ocamldebug_init_script ) )
+        debugger( DebuggerCommand( "source " + _ocamldebug_init_script, DebuggerCommand::SHOW_ALL_OUTPUT ) );
+    restoreBreakpoints();
+    emit debuggerStarted( true );
+    if ( _warm_standby )
+        spawnStandbyProcess();
+    return true;
+}
+
+QList<DebuggerCommand> OCamlDebugEngine::preludeCommands( const QString &socket ) const
+{
+    return QList<DebuggerCommand>()
+        << DebuggerCommand( "set loadingmode manual", DebuggerCommand::HIDE_ALL_OUTPUT )
+        << DebuggerCommand( "set socket " + socket, DebuggerCommand::HIDE_DEBUGGER_OUTPUT );
+}
+
+// Unix domain socket if available, otherwise the next free TCP port after port
+QString OCamlDebugEngine::newSocket( int &port ) const
+{
+    QString socket = unixSocketPath();
+    if ( !socket.isEmpty() )
+    {
+        QFile::remove( socket );
+        return socket;
+    }
+    port = findFreeServerPort( port );
+    if ( port == 0 )
+        return QString();
+    return "127.0.0.1:" + QString::number( port );
+}
+
+QProcess * OCamlDebugEngine::spawnProcess()
+{
+    QStringList args;
+    args
+        << _arguments.ocamlDebugArguments()
+        << _arguments.ocamlApp()
+        << _arguments.ocamlAppArguments()
+        ;
+
+    QProcess *spawned_p = new QProcess(this) ;
+    spawned_p->setProcessChannelMode(QProcess::MergedChannels);
+    spawned_p->start( _ocamldebug , args );
+    return spawned_p;
+}
+
+QString OCamlDebugEngine::processKey() const
+{
+    return ( QStringList()
+        << _ocamldebug
+        << _arguments.ocamlDebugArguments()
+        << _arguments.ocamlApp()
+        << _arguments.ocamlAppArguments()
+        << QString::number( _unix_socket )
+        ).join( QChar( 0 ) );
+}
+
+// ocamldebug loads the program only at the first 'goto 0' in manual loading mode,
+// so the standby process stays valid across rebuilds of the application.
+void OCamlDebugEngine::spawnStandbyProcess()
+{
+    discardStandbyProcess();
+    int port = _current_port;
+    _standby_socket = newSocket( port );
+    if ( _standby_socket.isEmpty() )
+        return;
+    _standby_port = port;
+    _standby_key = processKey();
+    _standby_p = spawnProcess();
+
+    QByteArray data;
+    QList<DebuggerCommand> prelude = preludeCommands( _standby_socket );
+    for ( QList<DebuggerCommand>::const_iterator itCommand = prelude.begin(); itCommand != prelude.end(); ++itCommand )
+        data += ( itCommand->command() + '\n' ).toLatin1();
+    _standby_p->write( data );
+}
+
+bool OCamlDebugEngine::takeStandbyProcess()
+{
+    if ( _standby_p == NULL )
+        return false;
+    if ( _standby_key != processKey() || !_standby_p->waitForStarted() || _standby_p->state() != QProcess::Running )
+    {
+        discardStandbyProcess();
+        return false;
+    }
+    process_p = _standby_p;
+    _socket = _standby_socket;
+    _current_port = _standby_port;
+    _standby_p = NULL;
+    _standby_socket.clear();
+    return true;
+}
+
+void OCamlDebugEngine::discardStandbyProcess()
+{
+    if ( _standby_p )
+    {
+        _standby_p->kill();
+        _standby_p->waitForFinished( 1000 );
+        delete _standby_p;
+        _standby_p = NULL;
+    }
+    if ( !_standby_socket.isEmpty() && !_standby_socket.contains( ':' ) )
+        QFile::remove( _standby_socket );
+    _standby_socket.clear();
+}
+
+void OCamlDebugEngine::addBreakpointCommand( const BreakPoint &breakpoint )
+{
+    QString command = breakpointCommand( breakpoint );
+    if ( _pending_breakpoint_commands.contains( command ) )
+        breakpointRestored( command, true );
+    if ( command.isEmpty() || _breakpoint_commands.contains( command ) )
+        return;
+    _breakpoint_commands << command;
+    emit breakpointCommandsChanged( _breakpoint_commands );
+}
+
+void OCamlDebugEngine::removeBreakpointCommand( const BreakPoint &breakpoint )
+{
+    QString command = breakpointCommand( breakpoint );
+    for (BreakPoints::const_iterator itBreakpoint = _breakpoints.begin() ; itBreakpoint != _breakpoints.end() ; ++itBreakpoint )
+    {
+        if ( itBreakpoint.value().id != breakpoint.id && breakpointCommand( itBreakpoint.value() ) == command )
+            return;
+    }
+    if ( _breakpoint_commands.removeAll( command ) > 0 )
+        emit breakpointCommandsChanged( _breakpoint_commands );
+    if ( _logpoints.remove( command ) > 0 )
+        emit logpointsChanged( logpoints() );
+    if ( _conditions.remove( command ) > 0 )
+        emit breakpointConditionsChanged( breakpointConditions() );
+}
+
+// A logpoint is the breakpoint created by 'breakpoint_command' together
+// with the expressions printed when it is hit.
+void OCamlDebugEngine::setLogpoint( const QString &breakpoint_command, const QStringList &expressions )
+{
+    if ( expressions.isEmpty() )
+        _logpoints.remove( breakpoint_command );
+    else
+        _logpoints[ breakpoint_command ] = expressions;
+
+    bool changed = false;
+    for ( BreakPoints::iterator itBreakpoint = _breakpoints.begin(); itBreakpoint != _breakpoints.end(); ++itBreakpoint )
+    {
+        if ( breakpointCommand( itBreakpoint.value() ) == breakpoint_command )
+        {
+            itBreakpoint->log = expressions;
+            changed = true;
+        }
+    }
+    if ( changed )
+        breakpointsChanged();
+    emit logpointsChanged( logpoints() );
+}
+
+// Each entry is the breakpoint command followed by the expressions, separated by tabulations
+void OCamlDebugEngine::setLogpoints( const QStringList &entries )
+{
+    _logpoints.clear();
+    for ( QStringList::const_iterator itEntry = entries.begin(); itEntry != entries.end(); ++itEntry )
+    {
+        QStringList fields = itEntry->split( '\t', QString::SkipEmptyParts );
+        if ( fields.count() >= 2 )
+            _logpoints[ fields.takeFirst() ] = fields;
+    }
+}
+
+QStringList OCamlDebugEngine::logpoints() const
+{
+    QStringList entries;
+    for ( QMap<QString,QStringList>::const_iterator itLogpoint = _logpoints.begin(); itLogpoint != _logpoints.end(); ++itLogpoint )
+        entries << ( QStringList() << itLogpoint.key() << itLogpoint.value() ).join( '\t' );
+    return entries;
+}
+
+// The breakpoint stops only when the condition holds, from the hit_count-th time on.
+// Conditions compare the printed value of an expression, e.g. 'i >= 10000' or 'l.name = "x"'.
+void OCamlDebugEngine::setBreakpointCondition( int id, const QString &condition, int hit_count )
+{
+    BreakPoints::const_iterator itBreakpoint = _breakpoints.constFind( id );
+    if ( itBreakpoint == _breakpoints.constEnd() )
+        return;
+    QString breakpoint_command = breakpointCommand( itBreakpoint.value() );
+    BreakpointCondition breakpoint_condition;
+    breakpoint_condition.condition = condition.trimmed();
+    breakpoint_condition.hit_count = hit_count;
+    if ( breakpoint_condition.condition.isEmpty() && hit_count <= 1 )
+        _conditions.remove( breakpoint_command );
+    else
+        _conditions[ breakpoint_command ] = breakpoint_condition;
+
+    for ( BreakPoints::iterator itBreakpoint = _breakpoints.begin(); itBreakpoint != _breakpoints.end(); ++itBreakpoint )
+    {
+        if ( breakpointCommand( itBreakpoint.value() ) == breakpoint_command )
+        {
+            itBreakpoint->condition = breakpoint_condition.condition;
+            itBreakpoint->hitCount = breakpoint_condition.hit_count;
+            _hit_counters.remove( itBreakpoint.key() );
+        }
+    }
+    breakpointsChanged();
+    emit breakpointConditionsChanged( breakpointConditions() );
+}
+
+// Each entry is the breakpoint command, the hit count and the condition, separated by tabulations
+void OCamlDebugEngine::setBreakpointConditions( const QStringList &entries )
+{
+    _conditions.clear();
+    for ( QStringList::const_iterator itEntry = entries.begin(); itEntry != entries.end(); ++itEntry )
+    {
+        QStringList fields = itEntry->split( '\t' );
+        if ( fields.count() == 3 )
+        {
+            BreakpointCondition breakpoint_condition;
+            breakpoint_condition.hit_count = fields.at( 1 ).toInt();
+            breakpoint_condition.condition = fields.at( 2 );
+            _conditions[ fields.at( 0 ) ] = breakpoint_condition;
+        }
+    }
+}
+
+QStringList OCamlDebugEngine::breakpointConditions() const
+{
+    QStringList entries;
+    for ( QMap<QString,BreakpointCondition>::const_iterator itCondition = _conditions.begin(); itCondition != _conditions.end(); ++itCondition )
+        entries << ( QStringList() << itCondition.key() << QString::number( itCondition->hit_count ) << itCondition->condition ).join( '\t' );
+    return entries;
+}
+
+void OCamlDebugEngine::breakpointsChanged()
+{
+    _breakpoint_index.setBreakpoints( _breakpoints );
+    emit breakPointList( _breakpoints );
+}
+
+// The breakpoints are written to ocamldebug in one batch, without waiting for each prompt
+void OCamlDebugEngine::restoreBreakpoints()
+{
+    _breakpoints.clear();
+    breakpointsChanged();
+
+    _pending_breakpoint_commands = _breakpoint_commands.toSet();
+    _unrestored_breakpoint_commands.clear();
+    _breakpoints_restored = false;
+    for (QStringList::const_iterator itCommand = _breakpoint_commands.begin(); itCommand != _breakpoint_commands.end(); ++itCommand )
+    {
+        DebuggerCommand command( *itCommand, DebuggerCommand::HIDE_ALL_OUTPUT );
+        command.setPipelined( true );
+        debugger( command );
+    }
+}
+
+// The commands which could not be restored are dropped from the saved list only
+// if another breakpoint was restored: if none was (the program cannot be loaded,
+// a module is missing during a rebuild...), the saved list is kept as is.
+void OCamlDebugEngine::breakpointRestored( const QString &command, bool restored )
+{
+    _pending_breakpoint_commands.remove( command );
+    if ( restored )
+        _breakpoints_restored = true;
+    else
+        _unrestored_breakpoint_commands << command;
+    if ( !_pending_breakpoint_commands.isEmpty() )
+        return;
+
+    if ( _breakpoints_restored && !_unrestored_breakpoint_commands.isEmpty() )
+    {
+        for ( QStringList::const_iterator itCommand = _unrestored_breakpoint_commands.begin(); itCommand != _unrestored_breakpoint_commands.end(); ++itCommand )
+            _breakpoint_commands.removeAll( *itCommand );
+        emit breakpointCommandsChanged( _breakpoint_commands );
+    }
+    _unrestored_breakpoint_commands.clear();
+}
+
+QString OCamlDebugEngine::breakpointCommand( const BreakPoint &breakpoint )
+{
+    if ( !breakpoint.command.isEmpty() )
+        return breakpoint.command;
+
+    QString module = ModuleIndex::moduleName( breakpoint.file );
+    if ( module.isEmpty() )
+        return QString();
+
+    return QString("break @ %1 %2 %3")
+        .arg(module)
+        .arg( QString::number( breakpoint.toLine  ) )
+        .arg( QString::number( breakpoint.toColumn ) );
+}
+
+void OCamlDebugEngine::receiveDataFromProcessStdError()
+{
+    if (process_p)
+    {
+        process_p->setReadChannel(QProcess::StandardError);
+        readChannel();
+    }
+}
+
+void OCamlDebugEngine::receiveDataFromProcessStdOutput()
+{
+    if (process_p)
+    {
+        process_p->setReadChannel(QProcess::StandardOutput);
+        readChannel();
+    }
+}
+
+// Everything buffered is consumed: a process taken over from the standby has
+// its banner and prelude answers already buffered, and no further readyRead
+// is emitted for them.
+void OCamlDebugEngine::readChannel()
+{
+    while ( process_p && process_p->bytesAvailable() > 0 )
+    {
+        if ( process_p->canReadLine() )
+            appendText( process_p->readLine() );
+        else
+            appendText( process_p->readAll() );
+    }
+}
+
+// Feeds ocamldebug output which was not read from the process (recorded transcripts)
+void OCamlDebugEngine::processOutput( const QByteArray &output )
+{
+    int pos = 0;
+    while ( pos < output.length() )
+    {
+        int end = output.indexOf( '\n', pos );
+        if ( end < 0 )
+            end = output.length();
+        else
+            end++;
+        appendText( output.mid( pos, end - pos ) );
+        pos = end;
+    }
+}
+
+// ocamldebug glues the answer of a command to the prompt completing the
+// previous one ("(ocd) Breakpoint 2 at ..."), and several prompts may arrive
+// in one chunk ("(ocd) (ocd) "). Each leading prompt completes the command at
+// the head of the queue before the rest is parsed against the next command.
+void OCamlDebugEngine::appendText( const QByteArray &text )
+{
+    TRACE_SCOPE( "OCamlDebugEngine::appendText" );
+    QByteArray rest = text;
+    while ( !rest.isEmpty() && readyRx.indexIn( QString::fromLatin1( rest ) ) == 0 )
+    {
+        int length = qMax( 1, readyRx.matchedLength() );
+        appendAnswer( rest.left( length ) );
+        rest = rest.mid( length );
+    }
+    if ( !rest.isEmpty() )
+        appendAnswer( rest );
+}
+
+void OCamlDebugEngine::appendAnswer( const QByteArray &text )
+{
+    qint64 received = _clock.nsecsElapsed();
+    bool display = true;
+    bool debugger_command = false;
+    DebuggerCommand::Option command_option = DebuggerCommand::SHOW_ALL_OUTPUT ;
+    QString command ;
+    if ( !_command_queue.isEmpty() )
+    {
+        command_option = _command_queue.first().option();
+        command = _command_queue.first().command();
+    }
+    QString data = QString::fromLatin1( text ).remove( '\r' );
+    bool command_completed = readyRx.indexIn( data ) >= 0;
+    if ( command_completed )
+    {
+        debugger_command = true;
+        data =  data.remove( readyRx );
+    }
+
+    if ( deleteBreakpointRx.indexIn(data) == 0 )
+    {
+        QString _id = deleteBreakpointRx.cap(1);
+        bool ok;
+        int id = _id.toInt(&ok);
+        if (ok)
+        {
+            debugger_command = true;
+            BreakPoints::iterator itBreakpoint = _breakpoints.find( id );
+            if ( itBreakpoint != _breakpoints.end() )
+            {
+                BreakPoint breakpoint = itBreakpoint.value();
+                _breakpoints.erase( itBreakpoint );
+                removeBreakpointCommand( breakpoint );
+            }
+            breakpointsChanged();
+        }
+    }
+    else if ( hitBreakpointRx.indexIn(data) == 0 )
+    {
+        QList<int> ids ;
+        int pos = 0;
+        while ((pos = hitBreakpointIdRx.indexIn(data, pos)) != -1)
+        {
+            QString sid = hitBreakpointIdRx.cap( 0 );
+            bool ok;
+            int id = sid.simplified().toInt( &ok );
+            if ( ok )
+                ids << id;
+            pos += hitBreakpointIdRx.matchedLength();
+        }
+        debugger_command = true;
+        _breakpoint_hits = ids;
+    }
+    else if ( newBreakpointRx.indexIn(data) == 0 )
+    {
+        BreakPoint breakpoint;
+        breakpoint.command = command;
+        QString _id = newBreakpointRx.cap(1);
+        breakpoint.file = newBreakpointRx.cap(2);
+        QString _line = newBreakpointRx.cap(3);
+        QString _from_char = newBreakpointRx.cap(4);
+        QString _to_char = newBreakpointRx.cap(5);
+        bool ok;
+        breakpoint.id = _id.toInt(&ok);
+        if (ok)
+            breakpoint.fromLine = _line.toInt(&ok);
+        breakpoint.toLine = breakpoint.fromLine;
+        if (ok)
+            breakpoint.fromColumn = _from_char.toInt(&ok);
+        if (ok)
+            breakpoint.toColumn = _to_char.toInt(&ok);
+        if (ok)
+        {
+            debugger_command = true;
+            breakpoint.log = _logpoints.value( breakpointCommand( breakpoint ) );
+            breakpoint.condition = _conditions.value( breakpointCommand( breakpoint ) ).condition;
+            breakpoint.hitCount = _conditions.value( breakpointCommand( breakpoint ) ).hit_count;
+            _breakpoints[ breakpoint.id ] = breakpoint;
+            addBreakpointCommand( breakpoint );
+            breakpointsChanged();
+        }
+    }
+    else if ( emacsLineInfoRx.indexIn(data) == 0 )
+    {
+        display = false ;
+        QString file = emacsLineInfoRx.cap(1);
+        QString start_char_str = emacsLineInfoRx.cap(2);
+        QString end_char_str = emacsLineInfoRx.cap(3);
+        QString instruction = emacsLineInfoRx.cap(4);
+        bool after = instruction == "after";
+        bool filtered = false;
+
+        bool ok;
+        int start_char = start_char_str.toInt(&ok);
+        if (ok)
+        {
+            int end_char = end_char_str.toInt(&ok);
+
+            if (ok)
+            {
+                QString filter_command;
+                if ( _breakpoint_hits.isEmpty() && _step_filter_count < 256 && isStepFiltered( file ) )
+                    filter_command = stepFilterCommand( command );
+                if ( !_stops_reported )
+                    filtered = true;
+                else if ( isFrameCommand( command ) )
+                {
+                    // selecting a frame moves the displayed location, not the execution
+                    filtered = true;
+                    emit frameSelected( file , start_char , end_char , after );
+                }
+                else if ( !_breakpoint_hits.isEmpty() && breakpointsHit( command, file, start_char, end_char, after ) )
+                    filtered = true;
+                else if ( !filter_command.isEmpty() )
+                {
+                    // the stop is hidden from the widgets: leave the filtered
+                    // module before any command not yet written
+                    filtered = true;
+                    _step_filter_count++;
+                    queueHiddenCommand( qMax( 1, _written_commands ), filter_command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT );
+                }
+                else
+                {
+                    TRACE_SCOPE( "OCamlDebugEngine::stopDebugging" );
+                    _step_filter_count = 0;
+                    emit stopDebugging( file , start_char , end_char , after );
+                    if ( _time >= 0)
+                        emit timeMarker( _time );
+                }
+            }
+        }
+        if ( !filtered )
+            emit breakPointHit( _breakpoint_hits );
+        _breakpoint_hits.clear();
+    }
+    else if ( timeInfoRx.exactMatch(data) )
+    {
+        QString time = timeInfoRx.cap(1);
+        bool ok;
+        int t = time.toInt(&ok);
+        if ( ok )
+        {
+            debugger_command = true;
+            _time = t;
+        }
+    }
+    else if ( ocamlrunConnectionRx.exactMatch(data) )
+    {
+        debugger_command = true;
+        emit applicationConnection( _socket );
+    }
+    else if ( emacsHaltInfoRx.exactMatch(data) )
+    {
+        display = false ;
+        _step_filter_count = 0;
+        if ( _stops_reported )
+        {
+            emit stopDebugging( QString() , 0 , 0 , false);
+            if ( _time >= 0)
+                emit timeMarker( _time );
+            emit breakPointHit( _breakpoint_hits );
+        }
+        _breakpoint_hits.clear();
+    }
+    else
+    {
+        for (QList<QRegExp>::iterator itRx = _debuggerOutputsRx.begin() ; itRx !=_debuggerOutputsRx.end() ; ++itRx )
+        {
+            if ( itRx->exactMatch(data) )
+                debugger_command = true;
+        }
+    }
+
+    if ( display )
+    {
+        if ( !_command_queue.isEmpty() )
+            _command_queue.first().appendResult( data );
+
+        if (
+                 !debugger_command
+                 &&
+                 command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT
+           )
+        {
+            if ( !data.isEmpty() )
+                if ( !_command_queue.isEmpty() )
+                    _command_queue.first().setOption( DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT );
+        }
+        if ( _time >= 0 && command_completed )
+            emit timeMarker( _time );
+        if (
+                command_option == DebuggerCommand::SHOW_ALL_OUTPUT
+                ||
+                command_option == DebuggerCommand::IMMEDIATE_COMMAND
+                ||
+                (
+                 !debugger_command
+                 &&
+                 (
+                  command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT
+                  ||
+                  command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT
+                 )
+                )
+                ||
+                (
+                 command_completed
+                 &&
+                 command_option == DebuggerCommand::HIDE_DEBUGGER_OUTPUT_SHOW_PROMT
+                )
+           )
+        {
+            emit output( QString::fromUtf8( text ) );
+        }
+        emit commandQueueChanged();
+    }
+    if ( command_completed )
+    {
+        if ( !_command_queue.isEmpty() )
+        {
+            DebuggerCommand completed_command = _command_queue.first();
+            completed_command.setCompleted( received );
+            if ( _pending_breakpoint_commands.contains( completed_command.command() ) )
+                breakpointRestored( completed_command.command(), false );
+            if ( !completed_command.internal() )
+                emit debuggerCommand( completed_command.command(), completed_command.result() );
+            if ( !_logpoint_prints.isEmpty() && _logpoint_prints.first().command == completed_command.command() )
+            {
+                const LogpointPrint &print = _logpoint_prints.first();
+                emit logpointHit( print.id, print.time, completed_command.result().trimmed() );
+                _logpoint_prints.removeFirst();
+            }
+            _command_queue.removeFirst();
+            if ( _written_commands > 0 )
+                _written_commands--;
+            if ( !_condition_prints.isEmpty() && _condition_prints.first().command == completed_command.command() )
+                conditionEvaluated( completed_command.result() );
+            completed_command.addProcessingTime( _clock.nsecsElapsed() - received );
+            _statistics.append( completed_command );
+            emit commandCompleted( completed_command );
+        }
+        processOneQueuedCommand();
+    }
+    else if ( !_command_queue.isEmpty() )
+        _command_queue.first().addProcessingTime( _clock.nsecsElapsed() - received );
+}
+
+void OCamlDebugEngine::interrupt()
+{
+#if !defined (Q_OS_WIN32)
+    if ( process_p )
+    {
+        int pid = process_p->pid();
+        ::kill( pid , SIGINT );
+    }
+#endif
+}
+
+void OCamlDebugEngine::debugger( const DebuggerCommand &command )
+{
+    if ( command.option() == DebuggerCommand::IMMEDIATE_COMMAND )
+    {
+        _command_queue.clear();
+        _logpoint_prints.clear();
+        _condition_prints.clear();
+        _written_commands = 0;
+    }
+
+    DebuggerCommand command_copy = command;
+    command_copy.setEnqueued( _clock.nsecsElapsed() );
+    if ( _display_all_commands )
+        command_copy.setOption( DebuggerCommand::SHOW_ALL_OUTPUT );
+    _command_queue.append( command_copy );
+
+    processOneQueuedCommand();
+}
+
+// Writes the first command of the queue, or all the following pipelined
+// commands if the commands already written are pipelined
+void OCamlDebugEngine::processOneQueuedCommand()
+{
+    if ( process_p == NULL )
+        return ;
+    QByteArray data;
+    while ( _written_commands < _command_queue.count() )
+    {
+        if ( _written_commands > 0 &&
+                !( _command_queue.at( _written_commands - 1 ).pipelined() && _command_queue.at( _written_commands ).pipelined() ) )
+            break;
+
+        DebuggerCommand &queued_command = _command_queue[ _written_commands ];
+        QString command = queued_command.command();
+        bool show_command =
+            queued_command.option() == DebuggerCommand::SHOW_ALL_OUTPUT
+            ||
+            queued_command.option() == DebuggerCommand::IMMEDIATE_COMMAND
+            ;
+        emit commandWritten( command, show_command );
+        queued_command.setWritten( _clock.nsecsElapsed() );
+        data += (command+'\n').toLatin1();
+        _written_commands++;
+    }
+    if ( !data.isEmpty() )
+        process_p->write( data );
+    else if ( _command_queue.isEmpty() )
+        emit commandQueueChanged();
+}
+
+int OCamlDebugEngine::findFreeServerPort( int port ) const
+{
+    int offset = 0;
+    int free_port;
+    do
+    {
+        offset++;
+        free_port = port + offset;
+        QTcpServer tcp_server;
+        if ( tcp_server.listen( QHostAddress( "127.0.0.1" ), free_port ) )
+        {
+            tcp_server.close();
+            return free_port;
+        }
+        if ( free_port > _port_max )
+            free_port = _port_min ;
+    }
+    while ( port != free_port );
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+#ifndef OCAMLDEBUGENGINE_H
+#define OCAMLDEBUGENGINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QRegExp>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDateTime>
+#include "filesystemwatcher.h"
+#include "breakpoint.h"
+#include "breakpointindex.h"
+#include "debuggercommand.h"
+#include "arguments.h"
+#include "commandstatistics.h"
+
+class OCamlDebugEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    OCamlDebugEngine( QObject *parent_p, const QString &ocamldebug, const Arguments &arguments, const QString & init_script );
+    virtual ~OCamlDebugEngine( );
+    void setArguments(const Arguments &arguments );
+    const Arguments & arguments() const { return _arguments; }
+    void setOCamlDebug(const QString &);
+    void setInitializationScript( const QString &s ) { _ocamldebug_init_script =s ; }
+    void setBreakpointCommands( const QStringList &c ) { _breakpoint_commands = c ; }
+    const QStringList & breakpointCommands() const { return _breakpoint_commands; }
+    void setLogpoint( const QString &breakpoint_command, const QStringList &expressions );
+    void setLogpoints( const QStringList & );
+    QStringList logpoints() const;
+    void setBreakpointCondition( int id, const QString &condition, int hit_count );
+    void setBreakpointConditions( const QStringList & );
+    QStringList breakpointConditions() const;
+    void setPort( int port ) { _current_port = port ; }
+    int port() const { return _current_port; }
+    void setUnixSocket( bool b ) { _unix_socket = b ; }
+    bool unixSocket() const { return _unix_socket; }
+    const QString & socket() const { return _socket; }
+    void setSettleTime( int ms ) { _settle_timer.setInterval( ms ) ; }
+    int settleTime() const { return _settle_timer.interval(); }
+    void setWarmStandby( bool b ) { _warm_standby = b ; }
+    bool warmStandby() const { return _warm_standby; }
+    void setStepFilters( const QStringList & );
+    const QStringList & stepFilters() const { return _step_filters; }
+    // While the stops are not reported, the execution is moved without
+    // notifying the widgets, neither applying filters, logpoints or conditions
+    void setStopsReported( bool b ) { _stops_reported = b ; }
+    bool stopsReported() const { return _stops_reported; }
+    void setDisplayAllCommands( bool b ) { _display_all_commands = b ; }
+    bool displayAllCommands() const { return _display_all_commands; }
+    const BreakPoints & breakpoints() const { return _breakpoints; }
+    const BreakpointIndex & breakpointIndex() const { return _breakpoint_index; }
+    bool isRunning() const { return process_p != NULL; }
+    bool isCommandQueueEmpty() const { return _command_queue.isEmpty(); }
+    int time() const { return _time; }
+    void processOutput( const QByteArray & );
+    const CommandStatistics & statistics() const { return _statistics; }
+    void clearStatistics() { _statistics.clear(); }
+
+public slots:
+    bool start();
+    void stop();
+    void interrupt();
+    void debugger( const DebuggerCommand & command );
+
+private slots:
+    void receiveDataFromProcessStdOutput();
+    void receiveDataFromProcessStdError();
+    void applicationFileChanged();
+    void applicationFileSettled();
+
+signals:
+    void stopDebugging( const QString &, int , int , bool);
+    void frameSelected( const QString &, int , int , bool);
+    void breakPointList( const BreakPoints & );
+    void breakPointHit( const QList<int> & );
+    void breakpointCommandsChanged( const QStringList & );
+    void logpointsChanged( const QStringList & );
+    void breakpointConditionsChanged( const QStringList & );
+    void logpointHit( int id, int time, const QString &value );
+    void debuggerStarted( bool );
+    void debuggerCommand( const QString & command, const QString & result );
+    void commandWritten( const QString & command, bool echo );
+    void output( const QString & );
+    void timeMarker( int );
+    void commandQueueChanged( );
+    void commandCompleted( const DebuggerCommand & );
+    void applicationConnection( const QString &socket );
+    void applicationModified( );
+    void error( const QString & title, const QString & message );
+
+private:
+    void restoreBreakpoints();
+    void breakpointsChanged();
+    void addBreakpointCommand( const BreakPoint & );
+    void removeBreakpointCommand( const BreakPoint & );
+    static QString breakpointCommand( const BreakPoint & );
+    void processOneQueuedCommand();
+    bool isStepFiltered( const QString &file ) const;
+    bool breakpointsHit( const QString &command, const QString &file, int start_char, int end_char, bool after );
+    void conditionEvaluated( const QString &result );
+    void breakpointRestored( const QString &command, bool restored );
+    void queueHiddenCommand( int position, const QString &command, DebuggerCommand::Option option );
+    static QString breakpointResumeCommand( const QString &command );
+    static QString stepFilterCommand( const QString &command );
+    static bool isFrameCommand( const QString &command );
+    void readChannel();
+    void appendText(const QByteArray &);
+    void appendAnswer(const QByteArray &);
+    int findFreeServerPort( int ) const;
+    QString unixSocketPath() const;
+    QString newSocket( int &port ) const;
+    QList<DebuggerCommand> preludeCommands( const QString &socket ) const;
+    QProcess *spawnProcess();
+    QString processKey() const;
+    void spawnStandbyProcess();
+    bool takeStandbyProcess();
+    void discardStandbyProcess();
+
+    QProcess *process_p;
+    QProcess *_standby_p;
+    QString _standby_socket;
+    QString _standby_key;
+    int _standby_port;
+    bool _warm_standby;
+    FileSystemWatcher *file_watch_p;
+    QRegExp emacsLineInfoRx ;
+    QRegExp readyRx ;
+    QRegExp deleteBreakpointRx ;
+    QRegExp hitBreakpointRx ;
+    QRegExp hitBreakpointIdRx ;
+    QRegExp newBreakpointRx ;
+    QRegExp emacsHaltInfoRx ;
+    QRegExp timeInfoRx ;
+    QRegExp ocamlrunConnectionRx ;
+    QList<QRegExp> _debuggerOutputsRx;
+    QString _ocamldebug, _ocamldebug_init_script;
+    Arguments _arguments;
+    BreakPoints _breakpoints;
+    BreakpointIndex _breakpoint_index;
+    QStringList _breakpoint_commands;
+    QSet<QString> _pending_breakpoint_commands;
+    QStringList _unrestored_breakpoint_commands;
+    bool _breakpoints_restored;
+    QMap<QString,QStringList> _logpoints;
+    struct LogpointPrint
+    {
+        int id;
+        int time;
+        QString command;
+    };
+    QList<LogpointPrint> _logpoint_prints;
+    struct BreakpointCondition
+    {
+        QString condition;
+        int hit_count;
+        BreakpointCondition() : hit_count( 0 ) { }
+    };
+    QMap<QString,BreakpointCondition> _conditions;
+    QHash<int,int> _hit_counters;
+    struct ConditionPrint
+    {
+        int id;
+        QString condition;
+        QString command;
+    };
+    QList<ConditionPrint> _condition_prints;
+    // stop held back until its conditions are evaluated
+    struct DeferredStop
+    {
+        QString file;
+        int start_char, end_char;
+        bool after;
+        QList<int> hits;
+        QString resume_command;
+        int evaluations;
+        bool stop;
+    };
+    DeferredStop _deferred_stop;
+    QList<int> _breakpoint_hits;
+    QList<DebuggerCommand> _command_queue;
+    int _written_commands;
+    int _time;
+    const int _port_min, _port_max;
+    int _current_port;
+    bool _unix_socket;
+    QString _socket;
+    bool _display_all_commands;
+    QStringList _step_filters;
+    QList<QRegExp> _step_filters_rx;
+    int _step_filter_count;
+    bool _stops_reported;
+    QElapsedTimer _clock;
+    QTimer _settle_timer;
+    qint64 _settle_size;
+    QDateTime _settle_modified;
+    CommandStatistics _statistics;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include <QFile>
+#include <QCoreApplication>
+#include <stdio.h>
+#include "ocamldebugscript.h"
+
+OCamlDebugScript::OCamlDebugScript( OCamlDebugEngine *engine_p, const QStringList &commands, bool verbose, const QString &statistics_file ) : QObject( ),
+    _engine_p( engine_p ),
+    _commands( commands ),
+    _statistics_file( statistics_file ),
+    _out( stdout ),
+    _verbose( verbose ),
+    _exit_code( 0 )
+{
+    application_p = NULL;
+    connect( _engine_p, SIGNAL( commandWritten( const QString &, bool ) ), this, SLOT( commandWritten( const QString &, bool ) ) );
+    connect( _engine_p, SIGNAL( commandCompleted( const DebuggerCommand & ) ), this, SLOT( commandCompleted( const DebuggerCommand & ) ) );
+    connect( _engine_p, SIGNAL( output( const QString & ) ), this, SLOT( output( const QString & ) ) );
+    connect( _engine_p, SIGNAL( applicationConnection( const QString & ) ), this, SLOT( startApplication( const QString & ) ) );
+    connect( _engine_p, SIGNAL( error( const QString &, const QString & ) ), this, SLOT( error( const QString &, const QString & ) ) );
+}
+
+OCamlDebugScript::~OCamlDebugScript()
+{
+    if ( application_p )
+    {
+        application_p->kill();
+        application_p->waitForFinished( 1000 );
+        delete application_p;
+    }
+}
+
+QStringList OCamlDebugScript::readScript( const QString &file_name, bool *ok )
+{
+    QStringList commands;
+    QFile file( file_name );
+    *ok = file.open( QFile::ReadOnly | QFile::Text );
+    if ( !*ok )
+        return commands;
+
+    QTextStream in( &file );
+    while ( !in.atEnd() )
+    {
+        QString command = in.readLine().trimmed();
+        if ( command.isEmpty() || command.startsWith( '#' ) )
+            continue;
+        commands << command;
+    }
+    return commands;
+}
+
+void OCamlDebugScript::start()
+{
+    _remaining_commands = _commands;
+    _script_timer.start();
+    if ( ! _engine_p->start() )
+    {
+        finish( 1 );
+        return;
+    }
+    for ( QStringList::const_iterator itCommand = _commands.begin(); itCommand != _commands.end(); ++itCommand )
+        _engine_p->debugger( DebuggerCommand( *itCommand, DebuggerCommand::SHOW_ALL_OUTPUT ) );
+    if ( _remaining_commands.isEmpty() )
+        finish( 0 );
+}
+
+void OCamlDebugScript::finish( int exit_code )
+{
+    if ( exit_code == 0 )
+    {
+        printStatistics();
+        if ( !saveStatistics() )
+            exit_code = 1;
+    }
+    _exit_code = exit_code;
+    emit finished( exit_code );
+}
+
+void OCamlDebugScript::commandWritten( const QString &command, bool )
+{
+    if ( _verbose )
+    {
+        _out << command << '\n';
+        _out.flush();
+    }
+}
+
+void OCamlDebugScript::commandCompleted( const DebuggerCommand &command )
+{
+    if ( !_remaining_commands.isEmpty() && _remaining_commands.first() == command.command() )
+    {
+        _remaining_commands.removeFirst();
+        if ( _remaining_commands.isEmpty() )
+            finish( 0 );
+    }
+}
+
+void OCamlDebugScript::output( const QString &text )
+{
+    if ( _verbose )
+    {
+        _out << text;
+        _out.flush();
+    }
+}
+
+void OCamlDebugScript::startApplication( const QString &socket )
+{
+    if ( application_p )
+    {
+        application_p->kill();
+        application_p->waitForFinished( 1000 );
+        delete application_p;
+    }
+    application_p = new QProcess();
+    if ( _verbose )
+        application_p->setProcessChannelMode( QProcess::ForwardedChannels );
+    else
+    {
+        application_p->setStandardOutputFile( QProcess::nullDevice() );
+        application_p->setStandardErrorFile( QProcess::nullDevice() );
+    }
+    QStringList env = QProcess::systemEnvironment();
+    env << "CAML_DEBUG_SOCKET=" + socket ;
+    application_p->setEnvironment( env );
+    application_p->start( _engine_p->arguments().ocamlApp() , _engine_p->arguments().ocamlAppArguments() );
+}
+
+void OCamlDebugScript::error( const QString &title, const QString &message )
+{
+    QTextStream err( stderr );
+    err << title << ": " << message << '\n';
+}
+
+void OCamlDebugScript::printStatistics()
+{
+    double ms = 1000000.0;
+    const QMap<QString,CommandKindStatistics> &kinds = _engine_p->statistics().kinds();
+    _out << '\n' << tr( "Script executed in %1 ms" ).arg( _script_timer.nsecsElapsed() / ms, 0, 'f', 3 ) << '\n';
+    _out << QString( "%1 %2 %3 %4 %5 %6 %7" )
+        .arg( tr( "command" ), -16 )
+        .arg( tr( "count" ), 8 )
+        .arg( tr( "queue(ms)" ), 12 )
+        .arg( tr( "mean(ms)" ), 12 )
+        .arg( tr( "min(ms)" ), 12 )
+        .arg( tr( "max(ms)" ), 12 )
+        .arg( tr( "process(ms)" ), 12 )
+        << '\n';
+    for ( QMap<QString,CommandKindStatistics>::const_iterator itKind = kinds.begin(); itKind != kinds.end(); ++itKind )
+    {
+        _out << QString( "%1 %2 %3 %4 %5 %6 %7" )
+            .arg( itKind.key(), -16 )
+            .arg( itKind->count, 8 )
+            .arg( itKind->queue_total / ms / itKind->count, 12, 'f', 3 )
+            .arg( itKind->response_total / ms / itKind->count, 12, 'f', 3 )
+            .arg( itKind->response_min / ms, 12, 'f', 3 )
+            .arg( itKind->response_max / ms, 12, 'f', 3 )
+            .arg( itKind->processing_total / ms / itKind->count, 12, 'f', 3 )
+            << '\n';
+    }
+    _out.flush();
+}
+
+bool OCamlDebugScript::saveStatistics()
+{
+    if ( _statistics_file.isEmpty() )
+        return true;
+
+    QFile file( _statistics_file );
+    if ( !file.open( QFile::WriteOnly | QFile::Text ) )
+    {
+        error( tr( "Statistics" ), tr( "Unable to write '%1'." ).arg( _statistics_file ) );
+        return false;
+    }
+    if ( _statistics_file.endsWith( ".json", Qt::CaseInsensitive ) )
+        file.write( _engine_p->statistics().toJson() );
+    else
+        file.write( _engine_p->statistics().toCsv().toUtf8() );
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef OCAMLDEBUGSCRIPT_H
+#define OCAMLDEBUGSCRIPT_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "ocamldebugengine.h"
+
+class OCamlDebugScript : public QObject
+{
+    Q_OBJECT
+
+public:
+    OCamlDebugScript( OCamlDebugEngine *engine_p, const QStringList &commands, bool verbose, const QString &statistics_file );
+    virtual ~OCamlDebugScript( );
+    static QStringList readScript( const QString &file_name, bool *ok );
+    int exitCode() const { return _exit_code; }
+
+public slots:
+    void start();
+
+signals:
+    void finished( int );
+
+private slots:
+    void commandWritten( const QString &, bool );
+    void commandCompleted( const DebuggerCommand & );
+    void output( const QString & );
+    void startApplication( const QString & );
+    void error( const QString &, const QString & );
+
+private:
+    void printStatistics();
+    bool saveStatistics();
+    void finish( int );
+    OCamlDebugEngine *_engine_p;
+    QProcess *application_p;
+    QStringList _commands;
+    QStringList _remaining_commands;
+    QString _statistics_file;
+    QElapsedTimer _script_timer;
+    QTextStream _out;
+    bool _verbose;
+    int _exit_code;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include <QtGui>
+#include <QTreeWidgetItem>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QMenu>
+#include "ocamllogpoints.h"
+#include "options.h"
+#include "updatescheduler.h"
+
+OCamlLogpoints::OCamlLogpoints( QWidget *parent_p ) : 
+    QWidget(parent_p)
+{
+    setObjectName( "OCamlLogpoints" );
+    _max_items = Options::get_opt_int( "LOGPOINTS_HISTORY_SIZE", 100000 );
+
+    layout_p = new QVBoxLayout( );
+    log_p = new QTreeWidget() ;
+    layout_p->addWidget( log_p );
+    layout_p->setContentsMargins( 0,0,0,0 );
+    setLayout( layout_p );
+
+    QStringList headers ;
+    headers << tr( "Time" ) << tr( "Breakpoint" ) << tr( "Value" ) ;
+    log_p->setRootIsDecorated(false);
+    log_p->setUniformRowHeights( true );
+    log_p->setColumnCount( headers.count() );
+    log_p->setHeaderLabels( headers );
+    log_p->header()->restoreState( Options::get_opt_array( "OCamlLogpoints_State" ) );
+
+    setAttribute(Qt::WA_DeleteOnClose);
+}
+
+OCamlLogpoints::~OCamlLogpoints()
+{
+    Options::set_opt( "OCamlLogpoints_State", log_p->header()->saveState() );
+    qDeleteAll( _pending_items );
+    delete layout_p;
+    delete log_p;
+}
+
+void OCamlLogpoints::closeEvent(QCloseEvent *event)
+{
+    event->accept();
+}
+
+void OCamlLogpoints::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu( this );
+    menu.addAction( tr( "&Clear" ), this, SLOT( clearLog() ) );
+    menu.exec( event->globalPos() );
+}
+
+void OCamlLogpoints::logpointHit( int id, int time, const QString &value )
+{
+    QStringList columns;
+    columns << QString::number( time ) << QString::number( id ) << value.simplified();
+    QTreeWidgetItem *item_p = new QTreeWidgetItem( columns );
+    item_p->setFlags( Qt::ItemIsEnabled | Qt::ItemIsSelectable );
+    item_p->setToolTip( 2, value );
+    _pending_items.append( item_p );
+    UpdateScheduler::instance()->invoke( this, "appendHits" );
+}
+
+void OCamlLogpoints::appendHits()
+{
+    if ( _pending_items.isEmpty() )
+        return;
+    QScrollBar *scroll_p = log_p->verticalScrollBar();
+    bool at_end = scroll_p->value() == scroll_p->maximum();
+    // the oldest rows are removed in one batch, not one shift of the model per hit
+    int excess = _pending_items.count() - _max_items;
+    if ( excess > 0 )
+    {
+        qDeleteAll( _pending_items.begin(), _pending_items.begin() + excess );
+        _pending_items.erase( _pending_items.begin(), _pending_items.begin() + excess );
+    }
+    log_p->addTopLevelItems( _pending_items );
+    _pending_items.clear();
+    excess = log_p->topLevelItemCount() - _max_items;
+    if ( excess > 0 )
+        log_p->model()->removeRows( 0, excess );
+    if ( at_end )
+        log_p->scrollToBottom();
+}
+
+void OCamlLogpoints::clearLog()
+{
+    qDeleteAll( _pending_items );
+    _pending_items.clear();
+    log_p->clear();
+}
@@ -0,0 +1,38 @@
+#ifndef OCAMLLOGPOINTS_H
+#define OCAMLLOGPOINTS_H
+
+#include <QString>
+#include <QList>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <QTreeWidget>
+
+// Values recorded by the logpoints.
+// The hits are appended at most once per display frame.
+class OCamlLogpoints : public QWidget
+{
+    Q_OBJECT
+
+public:
+    OCamlLogpoints( QWidget * parent_p );
+    virtual ~OCamlLogpoints( );
+
+public slots:
+    void logpointHit( int id, int time, const QString &value );
+    void clearLog();
+
+private slots:
+    void appendHits();
+
+protected:
+    void closeEvent(QCloseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+
+private:
+    QVBoxLayout *layout_p;
+    QTreeWidget *log_p;
+    QList<QTreeWidgetItem*> _pending_items;
+    int _max_items;
+};
+
+#endif
@@ -54,10 +54,10 @@ void OCamlRun::setArguments( const Arguments & arguments )
     _arguments = arguments ;
 }
 
-void OCamlRun::startApplication( int port )
+void OCamlRun::startApplication( const QString &socket )
 {
     terminate();
-    startProcess ( port );
+    startProcess ( socket );
 }
 
 void OCamlRun::closeEvent(QCloseEvent *event)
@@ -96,7 +96,7 @@ void OCamlRun::keyReleaseEvent ( QKeyEvent * e )
     QPlainTextEdit::keyReleaseEvent ( e );
 }
 
-void OCamlRun::startProcess( int port )
+void OCamlRun::startProcess( const QString &socket )
 {
     clear();
     process_p =  new QProcess(this) ;
@@ -104,7 +104,7 @@ void OCamlRun::startProcess( int port )
     connect ( process_p , SIGNAL( readyReadStandardOutput() ) , this , SLOT( receiveDataFromProcessStdOutput()) );
     connect ( process_p , SIGNAL( readyReadStandardError() ) , this , SLOT( receiveDataFromProcessStdError()) );
     QStringList env = QProcess::systemEnvironment();
-    env << "CAML_DEBUG_SOCKET=127.0.0.1:" + QString::number( port ) ;
+    env << "CAML_DEBUG_SOCKET=" + socket ;
     process_p->setEnvironment(env);
 
     if ( _verbose )
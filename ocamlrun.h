@@ -19,7 +19,7 @@ public:
     OCamlRun( QWidget * parent_p, const Arguments & arguments);
     virtual ~OCamlRun( );
     void setArguments(const Arguments &arguments);
-    void startApplication(int port);
+    void startApplication(const QString &socket);
 
 protected:
     void closeEvent(QCloseEvent *event);
@@ -38,7 +38,7 @@ private slots:
     void setVerbose( bool );
 
 private:
-    void startProcess( int port );
+    void startProcess( const QString &socket );
     void clear();
     void terminate();
     void readChannel();
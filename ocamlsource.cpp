@@ -1,10 +1,15 @@
 #include <QtGui>
 #include "ocamlsource.h"
+#include "tracer.h"
 #include "options.h"
 #include "ocamlsourcehighlighter.h"
+#include "textdiff.h"
+#include "moduleindex.h"
 #include <QTimer>
+#include <QTextBlock>
 #include <QAction>
 #include <QMenu>
+#include <QInputDialog>
 #include <QScrollBar>
 #include <QApplication>
 
@@ -42,6 +47,7 @@ OCamlSource::OCamlSource()
     connect ( markCurrentLocationTimer , SIGNAL( timeout() ), this , SLOT( markCurrentLocation() ) );
     markCurrentLocationTimer->setSingleShot( true );
     file_watch_p = NULL;
+    _breakpoint_index_p = NULL;
 }
 
 OCamlSource::~OCamlSource()
@@ -163,6 +169,12 @@ void OCamlSource::resizeEvent( QResizeEvent *e )
     resizeLineSearch();
 }
 
+void OCamlSource::paintEvent( QPaintEvent *e )
+{
+    TRACE_SCOPE( "OCamlSource::paintEvent" );
+    QPlainTextEdit::paintEvent( e );
+}
+
 void OCamlSource::resizeLineSearch()
 {
     QRect cr = contentsRect();
@@ -184,6 +196,7 @@ void OCamlSource::resizeLineSearch()
 
 void OCamlSource::lineNumberAreaPaintEvent( QPaintEvent *event )
 {
+    TRACE_SCOPE( "OCamlSource::lineNumberAreaPaintEvent" );
     QPainter painter( lineNumberArea );
     painter.fillRect( event->rect(), Qt::lightGray );
     QTextBlock block = firstVisibleBlock();
@@ -209,6 +222,7 @@ void OCamlSource::lineNumberAreaPaintEvent( QPaintEvent *event )
 
 bool OCamlSource::loadFile( const QString &fileName )
 {
+    TRACE_SCOPE( "OCamlSource::loadFile" );
     QFile file( fileName );
     _start_char = 0;
     _end_char = 0;
@@ -242,6 +256,9 @@ void OCamlSource::closeEvent( QCloseEvent *event )
 void OCamlSource::setCurrentFile( const QString &fileName )
 {
     curFile = QFileInfo( fileName ).canonicalFilePath();
+    _breakpoint_key = BreakpointIndex::key( curFile );
+    _breakpoints.clear();
+    breakpointsChanged( _breakpoint_key );
     setWindowTitle( userFriendlyCurrentFile() );
     if ( file_watch_p )
         delete file_watch_p;
@@ -256,65 +273,62 @@ QString OCamlSource::strippedName( const QString &fullFileName )
 
 void OCamlSource::markBreakPoints(bool unmark)
 {
-    QFileInfo current_file_info( curFile ) ;
-    BreakPoints::const_iterator itBreakpoint ;
+    markBreakPoints( _breakpoints, unmark );
+}
 
-    for( itBreakpoint = _breakpoints.begin(); itBreakpoint != _breakpoints.end() ; ++itBreakpoint )
+void OCamlSource::markBreakPoints(const BreakPointList &breakpoints, bool unmark)
+{
+    TRACE_SCOPE( "OCamlSource::markBreakPoints" );
+    BreakPointList::const_iterator itBreakpoint ;
+
+    for( itBreakpoint = breakpoints.begin(); itBreakpoint != breakpoints.end() ; ++itBreakpoint )
     {
-        QFileInfo breakpoint_file_info( itBreakpoint.value().file ) ;
-        if ( breakpoint_file_info.fileName() == current_file_info.fileName() )
-        {
-            QTextCharFormat selectedFormat;
+        QTextCharFormat selectedFormat;
 
-            if ( unmark )
-                selectedFormat.setBackground( QColor( Qt::white ) );
-            else
-                selectedFormat.setBackground( QColor( Qt::red ).lighter() );
+        if ( unmark )
+            selectedFormat.setBackground( QColor( Qt::white ) );
+        else
+            selectedFormat.setBackground( QColor( Qt::red ).lighter() );
 
-            QTextCursor cur = textCursor();
-            int line        = itBreakpoint.value().fromLine;
-            int from_column = itBreakpoint.value().fromColumn;
-            int to_column   = itBreakpoint.value().toColumn;
+        QTextCursor cur = textCursor();
+        int line        = itBreakpoint->fromLine;
+        int from_column = itBreakpoint->fromColumn;
+        int to_column   = itBreakpoint->toColumn;
 
-            cur.movePosition( QTextCursor::Start, QTextCursor::MoveAnchor );
-            cur.movePosition( QTextCursor::NextBlock, QTextCursor::MoveAnchor, line-1 );
-            cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, from_column-1 );
-            cur.movePosition( QTextCursor::NextCharacter, QTextCursor::KeepAnchor, to_column - from_column );
+        cur.movePosition( QTextCursor::Start, QTextCursor::MoveAnchor );
+        cur.movePosition( QTextCursor::NextBlock, QTextCursor::MoveAnchor, line-1 );
+        cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, from_column-1 );
+        cur.movePosition( QTextCursor::NextCharacter, QTextCursor::KeepAnchor, to_column - from_column );
 
-            cur.mergeCharFormat( selectedFormat );
-        }
+        cur.mergeCharFormat( selectedFormat );
     }
 
     if ( !unmark )
     {
-        for( itBreakpoint = _breakpoints.begin(); itBreakpoint != _breakpoints.end() ; ++itBreakpoint )
+        for( itBreakpoint = breakpoints.begin(); itBreakpoint != breakpoints.end() ; ++itBreakpoint )
         {
-            QFileInfo breakpoint_file_info( itBreakpoint.value().file ) ;
-            if ( breakpoint_file_info.fileName() == current_file_info.fileName() )
-            {
-                QTextCharFormat selectedFormat;
+            QTextCharFormat selectedFormat;
+
+            selectedFormat.setBackground( QColor( Qt::red ) );
 
-                selectedFormat.setBackground( QColor( Qt::red ) );
+            QTextCursor cur = textCursor();
+            int line        = itBreakpoint->fromLine;
+            int from_column = itBreakpoint->fromColumn;
+            int to_column   = itBreakpoint->toColumn;
 
-                QTextCursor cur = textCursor();
-                int line        = itBreakpoint.value().fromLine;
-                int from_column = itBreakpoint.value().fromColumn;
-                int to_column   = itBreakpoint.value().toColumn;
+            cur.movePosition( QTextCursor::Start, QTextCursor::MoveAnchor );
+            cur.movePosition( QTextCursor::NextBlock, QTextCursor::MoveAnchor, line-1 );
+            cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, from_column-1 );
+            cur.movePosition( QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1 );
+            cur.mergeCharFormat( selectedFormat );
 
+            if ( to_column - from_column > 2 )
+            {
                 cur.movePosition( QTextCursor::Start, QTextCursor::MoveAnchor );
                 cur.movePosition( QTextCursor::NextBlock, QTextCursor::MoveAnchor, line-1 );
-                cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, from_column-1 );
+                cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, to_column - 2 );
                 cur.movePosition( QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1 );
                 cur.mergeCharFormat( selectedFormat );
-
-                if ( to_column - from_column > 2 )
-                {
-                    cur.movePosition( QTextCursor::Start, QTextCursor::MoveAnchor );
-                    cur.movePosition( QTextCursor::NextBlock, QTextCursor::MoveAnchor, line-1 );
-                    cur.movePosition( QTextCursor::NextCharacter, QTextCursor::MoveAnchor, to_column - 2 );
-                    cur.movePosition( QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1 );
-                    cur.mergeCharFormat( selectedFormat );
-                }
             }
         }
     }
@@ -322,6 +336,7 @@ void OCamlSource::markBreakPoints(bool unmark)
 
 void OCamlSource::markCurrentLocation()
 {
+    TRACE_SCOPE( "OCamlSource::markCurrentLocation" );
     timer_index++;
     if ( _start_char != 0  && _end_char != 0 )
     {
@@ -382,6 +397,7 @@ void OCamlSource::markCurrentLocation()
 
 QString OCamlSource::stopDebugging( const QString &file, int start_char, int end_char , bool after)
 {
+    TRACE_SCOPE( "OCamlSource::stopDebugging" );
     if ( curFile != file )
         loadFile( file );
     QTextCharFormat unselectedFormat;
@@ -413,20 +429,70 @@ QString OCamlSource::stopDebugging( const QString &file, int start_char, int end
     return text;
 }
 
+// Only the modified lines are replaced, so that the layout, the highlighting
+// and the scroll position of the unchanged parts are kept.
 void OCamlSource::fileChanged ( )
 {
+    TRACE_SCOPE( "OCamlSource::fileChanged" );
     const QString &fileName = curFile;
     QFile file( fileName );
+    if ( ! file.open( QFile::ReadOnly | QFile::Text ) )
+        return;
+    QTextStream in( &file );
+    QStringList lines = in.readAll().split( '\n' );
+    file.close();
+
+    QStringList document_lines;
+    for ( QTextBlock block = document()->begin(); block.isValid(); block = block.next() )
+        document_lines << block.text();
+
+    QList<LineDiffHunk> hunks = lineDiff( lines, document_lines );
+    if ( hunks.isEmpty() )
+        return;
+
+    QTextCursor cur( document() );
+    cur.beginEditBlock();
+    if ( _start_char != 0  && _end_char != 0 )
+    {
+        QTextCharFormat unmarkFormat;
+        unmarkFormat.setBackground( QColor( Qt::white ) );
+        cur.setPosition( _start_char );
+        cur.setPosition( qMin( _end_char, document()->characterCount() - 1 ), QTextCursor::KeepAnchor );
+        cur.mergeCharFormat( unmarkFormat );
+    }
     _start_char = 0;
     _end_char = 0;
-    if ( file.open( QFile::ReadOnly | QFile::Text ) )
+    markBreakPoints( true );
+
+    // from the end, so that the line numbers of the remaining hunks stay valid
+    for ( int i = hunks.count() - 1; i >= 0; i-- )
     {
-        QTextStream in( &file );
-        setPlainText( in.readAll() );
-        QApplication::restoreOverrideCursor();
-        file.close();
+        const LineDiffHunk &hunk = hunks.at( i );
+        QStringList inserted = lines.mid( hunk.curLine, hunk.curCount );
+        QTextBlock first = document()->findBlockByNumber( hunk.refLine );
+        QTextBlock next = document()->findBlockByNumber( hunk.refLine + hunk.refCount );
+        if ( next.isValid() )
+        {
+            cur.setPosition( first.position() );
+            cur.setPosition( next.position(), QTextCursor::KeepAnchor );
+            cur.insertText( inserted.isEmpty() ? QString() : inserted.join( "\n" ) + "\n", QTextCharFormat() );
+        }
+        else if ( hunk.refLine > 0 )
+        {
+            // the hunk ends the document: replace the preceding line separator instead
+            QTextBlock previous = document()->findBlockByNumber( hunk.refLine - 1 );
+            cur.setPosition( previous.position() + previous.length() - 1 );
+            cur.movePosition( QTextCursor::End, QTextCursor::KeepAnchor );
+            cur.insertText( inserted.isEmpty() ? QString() : "\n" + inserted.join( "\n" ), QTextCharFormat() );
+        }
+        else
+        {
+            cur.select( QTextCursor::Document );
+            cur.insertText( inserted.join( "\n" ), QTextCharFormat() );
+        }
     }
-    breakPointList( _breakpoints );
+    cur.endEditBlock();
+    markBreakPoints( false );
 }
 
 void OCamlSource::displayVar ( )
@@ -453,20 +519,37 @@ void OCamlSource::watchVar ( )
     setTextCursor( current_cur );
 }
 
+QString OCamlSource::breakpointCommand() const
+{
+    QString module = ModuleIndex::moduleName( curFile );
+    if (module.length() == 0)
+        return QString();
+    return QString("break @ %1 %2 %3")
+        .arg(module)
+        .arg( QString::number( _breakpoint_line ) )
+        .arg( QString::number( _breakpoint_column ) )
+        ;
+}
+
 void OCamlSource::newBreakpoint ( )
 {
-    QFileInfo sourceInfo( curFile );
-    QString module = sourceInfo.baseName();
-    if (module.length() > 0)
-    {
-        module[0] = module[0].toUpper();
-        QString command = QString("break @ %1 %2 %3")
-            .arg(module)
-            .arg( QString::number( _breakpoint_line ) )
-            .arg( QString::number( _breakpoint_column ) )
-            ;
+    QString command = breakpointCommand();
+    if ( !command.isEmpty() )
         emit debugger( DebuggerCommand( command, DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
-    }
+}
+
+void OCamlSource::newLogpoint ( )
+{
+    QString command = breakpointCommand();
+    if ( command.isEmpty() )
+        return;
+    bool ok;
+    QString text = QInputDialog::getText( this, tr( "Logpoint" ),
+            tr( "Expressions printed at each hit (separated by spaces):" ), QLineEdit::Normal,
+            _selected_text.trimmed(), &ok );
+    QStringList expressions = text.split( ' ', QString::SkipEmptyParts );
+    if ( ok && !expressions.isEmpty() )
+        emit logpoint( command, expressions );
 }
 
 void OCamlSource::contextMenuEvent( QContextMenuEvent *event )
@@ -493,6 +576,13 @@ void OCamlSource::contextMenuEvent( QContextMenuEvent *event )
     breakAct->setStatusTip( tr( "Set a breakpoint to the current location" ) );
     connect( breakAct, SIGNAL( triggered() ), this, SLOT( newBreakpoint() ) );
 
+    QAction *logAct = new QAction( tr( "Set &Logpoint at line %1 column %2..." )
+            .arg( QString::number(mouse_position.blockNumber()+1))
+            .arg( QString::number(mouse_position.columnNumber()+1))
+            , this );
+    logAct->setStatusTip( tr( "Record expressions each time the current location is reached, without stopping" ) );
+    connect( logAct, SIGNAL( triggered() ), this, SLOT( newLogpoint() ) );
+
     QAction *displayAct = NULL;
     if ( cur.hasSelection() )
     {
@@ -522,6 +612,7 @@ void OCamlSource::contextMenuEvent( QContextMenuEvent *event )
     QMenu *menu = createStandardContextMenu();
 
     menu->addAction( breakAct );
+    menu->addAction( logAct );
     if (displayAct)
         menu->addAction( displayAct );
     if (printAct)
@@ -531,6 +622,7 @@ void OCamlSource::contextMenuEvent( QContextMenuEvent *event )
     menu->exec( event->globalPos() );
 
     delete breakAct;
+    delete logAct;
     if (displayAct)
         delete displayAct;
     if (printAct)
@@ -571,11 +663,43 @@ void OCamlSource::mousePressEvent ( QMouseEvent * e )
         QPlainTextEdit::mousePressEvent(e);
 }
 
-void OCamlSource::breakPointList( const BreakPoints &b )
+void OCamlSource::setBreakpointIndex( const BreakpointIndex *index_p )
 {
-    markBreakPoints(true);
-    _breakpoints = b;
-    markBreakPoints(false);
+    if ( _breakpoint_index_p )
+        disconnect( _breakpoint_index_p, SIGNAL( breakpointsChanged( const QString & ) ), this, SLOT( breakpointsChanged( const QString & ) ) );
+    _breakpoint_index_p = index_p;
+    if ( _breakpoint_index_p )
+        connect( _breakpoint_index_p, SIGNAL( breakpointsChanged( const QString & ) ), this, SLOT( breakpointsChanged( const QString & ) ) );
+    breakpointsChanged( _breakpoint_key );
+}
+
+// Only the breakpoints added or removed in this file are marked again
+void OCamlSource::breakpointsChanged( const QString &key )
+{
+    if ( key != _breakpoint_key )
+        return;
+
+    BreakPointList breakpoints;
+    if ( _breakpoint_index_p )
+        breakpoints = _breakpoint_index_p->breakpoints( _breakpoint_key );
+
+    BreakPointList added, removed;
+    for ( BreakPointList::const_iterator itBreakpoint = breakpoints.begin(); itBreakpoint != breakpoints.end(); ++itBreakpoint )
+        if ( !_breakpoints.contains( *itBreakpoint ) )
+            added << *itBreakpoint;
+    for ( BreakPointList::const_iterator itBreakpoint = _breakpoints.begin(); itBreakpoint != _breakpoints.end(); ++itBreakpoint )
+        if ( !breakpoints.contains( *itBreakpoint ) )
+            removed << *itBreakpoint;
+
+    _breakpoints = breakpoints;
+    if ( !removed.isEmpty() )
+    {
+        // the marks of overlapping breakpoints are restored as well
+        markBreakPoints( removed, true );
+        markBreakPoints( _breakpoints, false );
+    }
+    else if ( !added.isEmpty() )
+        markBreakPoints( added, false );
 }
 
 
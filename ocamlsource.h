@@ -8,6 +8,7 @@
 #include "ocamldebug.h"
 #include "ocamlsourcehighlighter.h"
 #include "filesystemwatcher.h"
+#include "breakpointindex.h"
 class OCamlSourceLineNumberArea ;
 class OCamlSourceSearch ;
 
@@ -27,9 +28,10 @@ class OCamlSource : public QPlainTextEdit
         int lineNumberAreaWidth();
         bool fromUserLoaded() const { return _from_user_loaded ; }
         void setFromUserLoaded( bool v ) { _from_user_loaded = v ;}
-        void breakPointList( const BreakPoints &b );
+        void setBreakpointIndex( const BreakpointIndex *index_p );
 
     private slots:
+        void breakpointsChanged( const QString &key );
         void searchTextChanged( const QString & ) ;
         void nextTextSearch() ;
     signals:
@@ -37,6 +39,7 @@ class OCamlSource : public QPlainTextEdit
         void displayVariable( const QString & );
         void printVariable( const QString & );
         void watchVariable( const QString & );
+        void logpoint( const QString &breakpoint_command, const QStringList &expressions );
         void releaseFocus();
     protected:
         virtual void keyPressEvent ( QKeyEvent * e );
@@ -46,19 +49,23 @@ class OCamlSource : public QPlainTextEdit
 
         private slots:
             void newBreakpoint ( );
+            void newLogpoint ( );
             void printVar ( );
             void watchVar ( );
             void displayVar ( );
         void markCurrentLocation();
         void markBreakPoints(bool);
+        void markBreakPoints(const BreakPointList &, bool);
         void fileChanged ( );
         void resizeEvent(QResizeEvent *event);
+        void paintEvent(QPaintEvent *event);
 
         private slots:
             void updateLineNumberAreaWidth(int newBlockCount);
         void updateLineNumberArea(const QRect &, int);
 
     private:
+        QString breakpointCommand() const;
         void resizeLineSearch();
         void setCurrentFile(const QString &fileName);
         QString strippedName(const QString &fullFileName);
@@ -77,7 +84,9 @@ class OCamlSource : public QPlainTextEdit
         OCamlSourceLineNumberArea *lineNumberArea;
         OCamlSourceSearch *lineSearchArea;
         bool _from_user_loaded;
-        BreakPoints _breakpoints;
+        const BreakpointIndex *_breakpoint_index_p;
+        QString _breakpoint_key;
+        BreakPointList _breakpoints;
 };
 
 
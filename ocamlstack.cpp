@@ -4,14 +4,20 @@
 #include <QStringListModel>
 #include "ocamlstack.h"
 #include "options.h"
+#include "tracer.h"
 #include <QHeaderView>
+#include <QScrollBar>
+
+// Number of frames fetched at each stop, and added when scrolling to the bottom
+static const int frames_page_size = 64;
 
 OCamlStack::OCamlStack( QWidget *parent_p ) : 
-    QWidget(parent_p),
-    stackRx( "^#([0-9]*)  *Pc *: *([0-9]+) *([^ ]+)  *char  *([0-9]+) *\\n?$" )
+    QWidget(parent_p)
 {
     setObjectName(QString("OCamlStack"));
     _current_frame = -1;
+    _requested_frames = frames_page_size;
+    _loading = false;
 
     layout_p = new QVBoxLayout( );
     stack_p = new QTreeWidget() ;
@@ -25,6 +31,8 @@ OCamlStack::OCamlStack( QWidget *parent_p ) :
     stack_p->setRootIsDecorated(false);
     stack_p->setColumnCount( headers.count() );
     stack_p->setHeaderLabels( headers );
+    stack_p->header()->setSectionResizeMode( 3, QHeaderView::ResizeToContents ); 
+    connect( stack_p->verticalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( stackScrolled( int ) ) );
     clearData();
     stack_p->header()->restoreState( Options::get_opt_array( "OCamlStack_State" ) );
 
@@ -43,6 +51,7 @@ void OCamlStack::clearData()
 {
     stack_p->clear();
     _stack.clear();
+    _loading = false;
 }
 
 void OCamlStack::closeEvent(QCloseEvent *event)
@@ -52,6 +61,7 @@ void OCamlStack::closeEvent(QCloseEvent *event)
 
 void OCamlStack::stopDebugging( const QString &file, int start_char, int end_char, bool after ) 
 {
+    TRACE_SCOPE( "OCamlStack::stopDebugging" );
     _file          = file;
     _start_char    = start_char;
     _end_char      = end_char;
@@ -62,56 +72,64 @@ void OCamlStack::stopDebugging( const QString &file, int start_char, int end_cha
 
 void OCamlStack::updateStack()
 {
-    emit debugger( DebuggerCommand( "backtrace", DebuggerCommand::HIDE_ALL_OUTPUT ) );
+    requestFrames( frames_page_size );
+}
+
+void OCamlStack::requestFrames( int frames )
+{
+    _requested_frames = frames;
+    _loading = true;
+    emit debugger( DebuggerCommand( "backtrace " + QString::number( frames ), DebuggerCommand::HIDE_ALL_OUTPUT ) );
+}
+
+void OCamlStack::stackScrolled( int value )
+{
+    if ( _loading || _stack.count() < _requested_frames )
+        return;
+    if ( value >= stack_p->verticalScrollBar()->maximum() - stack_p->verticalScrollBar()->pageStep() / 2 )
+        requestFrames( _requested_frames + frames_page_size );
 }
 
 void  OCamlStack::debuggerCommand( const QString &cmd, const QString &result)
 {
-    if ( cmd == "backtrace" )
+    TRACE_SCOPE( "OCamlStack::debuggerCommand" );
+    if ( cmd.startsWith( "backtrace" ) )
     {
-        _stack.clear();
-        QStringList results = result.split( '\n' );
-        for ( QStringList::const_iterator itResult = results.begin() ; itResult != results.end() ; ++itResult )
-        {
-            if ( stackRx.exactMatch( *itResult ) )
-            {
-                bool ok;
-                StackItem item;
-                item.frame = stackRx.cap(1).toInt( &ok );
-                if ( !ok )
-                    continue;
-                item.pc = stackRx.cap(2).toInt( &ok );
-                if ( !ok )
-                    continue;
-                item.module = stackRx.cap(3);
-                item.position = stackRx.cap(4).toInt( &ok );
-                if ( !ok )
-                    continue;
-
-                _stack.append( item );
-            }
-        }
+        _loading = false;
+        _stack = DebuggerReply::parseBacktrace( result );
+        updateRows();
     }
     else if ( cmd.startsWith( "do" ) || cmd.startsWith ("u") || cmd.startsWith( "fr" ) )
     {
-        QStringList results = result.split( '\n' );
-        for ( QStringList::const_iterator itResult = results.begin() ; itResult != results.end() ; ++itResult )
+        int current_frame = DebuggerReply::parseCurrentFrame( result );
+        if ( current_frame >= 0 && current_frame != _current_frame )
         {
-            if ( stackRx.exactMatch( *itResult ) )
-            {
-                bool ok;
-                StackItem item;
-                _current_frame = stackRx.cap(1).toInt( &ok );
-                if ( !ok )
-                    _current_frame = -1;
-            }
+            highlightFrame( _current_frame, false );
+            _current_frame = current_frame;
+            highlightFrame( _current_frame, true );
         }
     }
-    else
+}
+
+void OCamlStack::highlightFrame( int frame, bool current )
+{
+    QTreeWidgetItem *item_p = stack_p->topLevelItem( frame );
+    if ( item_p == NULL || item_p->text( 0 ).toInt() != frame )
         return;
+    for ( int i=0 ; i<4 ; i++ )
+    {
+        if ( current )
+            item_p->setBackground( i, Qt::yellow );
+        else
+            item_p->setData( i, Qt::BackgroundRole, QVariant() );
+    }
+}
 
-    stack_p->clear();
-    for (Stack::const_iterator itStack = _stack.begin() ; itStack != _stack.end() ; ++itStack )
+// Reuses the existing rows, only the texts of changed frames are updated
+void OCamlStack::updateRows()
+{
+    int row = 0;
+    for (StackFrames::const_iterator itStack = _stack.begin() ; itStack != _stack.end() ; ++itStack, ++row )
     {
         QStringList item ;
         item 
@@ -120,21 +138,35 @@ void  OCamlStack::debuggerCommand( const QString &cmd, const QString &result)
             << itStack->module
             << QString::number( itStack->position ) 
             ;
-        QTreeWidgetItem *item_p = new QTreeWidgetItem( item );
-        item_p->setFlags( Qt::ItemIsEnabled );
-        QFont f = font();
+        QTreeWidgetItem *item_p = stack_p->topLevelItem( row );
+        if ( item_p == NULL )
+        {
+            item_p = new QTreeWidgetItem( item );
+            item_p->setFlags( Qt::ItemIsEnabled );
+            stack_p->addTopLevelItem( item_p );
+        }
+        else
+        {
+            for ( int i=0 ; i<4 ; i++ )
+            {
+                if ( item_p->text( i ) != item.at( i ) )
+                    item_p->setText( i, item.at( i ) );
+            }
+        }
+        QString tooltip = tr( "Click to go to the frame '%0'." ).arg( item.at( 0 ) );
         bool is_current_frame = _current_frame == itStack->frame ;
         for ( int i=0 ; i<4 ; i++ )
         {
-            item_p->setFont( i, f );
-            item_p->setToolTip( i, tr( "Click to go to the frame '%0'." ).arg( QString::number( itStack->frame ) ) );
+            if ( item_p->toolTip( i ) != tooltip )
+                item_p->setToolTip( i, tooltip );
             if ( is_current_frame )
-                item_p->setBackgroundColor( i, Qt::yellow );
+                item_p->setBackground( i, Qt::yellow );
+            else if ( item_p->data( i, Qt::BackgroundRole ).isValid() )
+                item_p->setData( i, Qt::BackgroundRole, QVariant() );
         }
-        stack_p->header()->setSectionResizeMode( 3, QHeaderView::ResizeToContents ); 
-
-        stack_p->addTopLevelItem( item_p );
     }
+    while ( stack_p->topLevelItemCount() > row )
+        delete stack_p->takeTopLevelItem( row );
 }
 
 void OCamlStack::expressionClicked( QTreeWidgetItem *item_p , int )
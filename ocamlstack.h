@@ -10,20 +10,12 @@
 #include <QTreeWidget>
 #include <QCompleter>
 #include "ocamldebug.h"
+#include "debuggerreply.h"
 
 class OCamlStack : public QWidget
 {
     Q_OBJECT
 
-private:
-        struct StackItem
-        {
-            int frame;
-            int pc;
-            QString module;
-            int position;
-        };
-        typedef QList<StackItem> Stack ;
 public:
     OCamlStack( QWidget * parent_p );
     virtual ~OCamlStack( );
@@ -37,19 +29,24 @@ public slots:
     void debuggerStarted(bool b);
 protected slots:
     void expressionClicked( QTreeWidgetItem * , int );
+    void stackScrolled( int );
 protected:
     void closeEvent(QCloseEvent *event);
 
 private:
-    Stack _stack ;
+    StackFrames _stack ;
     int _start_char, _end_char;
     bool _after;
     QString _file;
     int _current_frame ;
+    int _requested_frames ;
+    bool _loading ;
     void clearData();
+    void requestFrames( int );
+    void updateRows();
+    void highlightFrame( int frame, bool current );
     QVBoxLayout *layout_p;
     QTreeWidget *stack_p;
-    QRegExp stackRx;
 };
 
 #endif
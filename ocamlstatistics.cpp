@@ -0,0 +1,148 @@
+#include <QtGui>
+#include <QTreeWidgetItem>
+#include <QHeaderView>
+#include <QMenu>
+#include <QFileDialog>
+#include <QMessageBox>
+#include "ocamlstatistics.h"
+#include "ocamldebugengine.h"
+#include "options.h"
+
+OCamlStatistics::OCamlStatistics( QWidget *parent_p, OCamlDebugEngine *engine_p ) : 
+    QWidget(parent_p),
+    _engine_p( engine_p )
+{
+    setObjectName( "OCamlStatistics" );
+
+    layout_p = new QVBoxLayout( );
+    statistics_p = new QTreeWidget() ;
+    layout_p->addWidget( statistics_p );
+    layout_p->setContentsMargins( 0,0,0,0 );
+    setLayout( layout_p );
+
+    QStringList headers ;
+    headers << tr( "Command" ) << tr( "Count" ) << tr( "Queue (ms)" ) << tr( "Response (ms)" ) << tr( "Min (ms)" ) << tr( "Max (ms)" ) << tr( "Processing (ms)" ) << tr( "Histogram" ) ;
+    statistics_p->setRootIsDecorated(false);
+    statistics_p->setColumnCount( headers.count() );
+    statistics_p->setHeaderLabels( headers );
+    statistics_p->header()->restoreState( Options::get_opt_array( "OCamlStatistics_State" ) );
+    statistics_p->setSortingEnabled( true );
+    connect( _engine_p, SIGNAL( commandCompleted( const DebuggerCommand & ) ), this, SLOT( commandCompleted( const DebuggerCommand & ) ) );
+
+    const QMap<QString,CommandKindStatistics> &kinds = _engine_p->statistics().kinds();
+    for ( QMap<QString,CommandKindStatistics>::const_iterator itKind = kinds.begin(); itKind != kinds.end(); ++itKind )
+        updateItem( itKind.key(), itKind.value() );
+
+    setAttribute(Qt::WA_DeleteOnClose);
+}
+
+OCamlStatistics::~OCamlStatistics()
+{
+    Options::set_opt( "OCamlStatistics_State", statistics_p->header()->saveState() );
+    delete layout_p;
+    delete statistics_p;
+}
+
+void OCamlStatistics::closeEvent(QCloseEvent *event)
+{
+    event->accept();
+}
+
+void OCamlStatistics::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu( this );
+    menu.addAction( tr( "&Export..." ), this, SLOT( exportStatistics() ) );
+    menu.addAction( tr( "&Reset" ), this, SLOT( resetStatistics() ) );
+    menu.exec( event->globalPos() );
+}
+
+void OCamlStatistics::commandCompleted( const DebuggerCommand &command )
+{
+    QString kind = CommandStatistics::kind( command.command() );
+    QMap<QString,CommandKindStatistics>::const_iterator itKind = _engine_p->statistics().kinds().find( kind );
+    if ( itKind != _engine_p->statistics().kinds().end() )
+        updateItem( kind, itKind.value() );
+}
+
+QString OCamlStatistics::histogram( const CommandKindStatistics &statistics )
+{
+    static const QString bars = QString::fromUtf8( " ▁▂▃▄▅▆▇█" );
+    int max = 0;
+    for ( int bucket = 0; bucket < statistics.histogram.count(); bucket++ )
+        max = qMax( max, statistics.histogram.at( bucket ) );
+
+    QString text;
+    for ( int bucket = 0; bucket < statistics.histogram.count(); bucket++ )
+    {
+        int count = statistics.histogram.at( bucket );
+        int level = 0;
+        if ( count > 0 && max > 0 )
+            level = 1 + ( count * ( bars.length() - 2 ) ) / max;
+        text += bars.at( level );
+    }
+    return text;
+}
+
+void OCamlStatistics::updateItem( const QString &kind, const CommandKindStatistics &statistics )
+{
+    QTreeWidgetItem *item_p = _items.value( kind, NULL );
+    if ( item_p == NULL )
+    {
+        item_p = new QTreeWidgetItem( );
+        item_p->setFlags( Qt::ItemIsEnabled );
+        item_p->setText( 0, kind );
+        for ( int i = 1; i < 7; i++ )
+            item_p->setTextAlignment( i, Qt::AlignRight );
+        statistics_p->addTopLevelItem( item_p );
+        _items[ kind ] = item_p;
+    }
+
+    double ms = 1000000.0;
+    item_p->setText( 1, QString::number( statistics.count ) );
+    item_p->setText( 2, QString::number( statistics.queue_total / ms / statistics.count, 'f', 2 ) );
+    item_p->setText( 3, QString::number( statistics.response_total / ms / statistics.count, 'f', 2 ) );
+    item_p->setText( 4, QString::number( statistics.response_min / ms, 'f', 2 ) );
+    item_p->setText( 5, QString::number( statistics.response_max / ms, 'f', 2 ) );
+    item_p->setText( 6, QString::number( statistics.processing_total / ms / statistics.count, 'f', 2 ) );
+    item_p->setText( 7, histogram( statistics ) );
+
+    QString tooltip;
+    for ( int bucket = 0; bucket < statistics.histogram.count(); bucket++ )
+    {
+        if ( statistics.histogram.at( bucket ) > 0 )
+            tooltip += QString( "%1: %2\n" ).arg( CommandStatistics::bucketName( bucket ) ).arg( statistics.histogram.at( bucket ) );
+    }
+    item_p->setToolTip( 7, tooltip.trimmed() );
+}
+
+void OCamlStatistics::exportStatistics()
+{
+    QString selected_filter;
+    QString file_name = QFileDialog::getSaveFileName( this,
+            tr( "Export Command Statistics" ),
+            Options::get_opt_str( "STATISTICS_EXPORT_FILE" ),
+            tr( "CSV (*.csv);;JSON (*.json)" ),
+            &selected_filter );
+    if ( file_name.isEmpty() )
+        return;
+
+    bool json = file_name.endsWith( ".json", Qt::CaseInsensitive ) || selected_filter.contains( "json" );
+    QFile file( file_name );
+    if ( !file.open( QFile::WriteOnly | QFile::Text ) )
+    {
+        QMessageBox::warning( this, tr( "Export Command Statistics" ), tr( "Unable to write '%1'." ).arg( file_name ) );
+        return;
+    }
+    if ( json )
+        file.write( _engine_p->statistics().toJson() );
+    else
+        file.write( _engine_p->statistics().toCsv().toUtf8() );
+    Options::set_opt( "STATISTICS_EXPORT_FILE", file_name );
+}
+
+void OCamlStatistics::resetStatistics()
+{
+    _engine_p->clearStatistics();
+    statistics_p->clear();
+    _items.clear();
+}
@@ -0,0 +1,40 @@
+#ifndef OCAMLSTATISTICS_H
+#define OCAMLSTATISTICS_H
+
+#include <QString>
+#include <QMap>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <QTreeWidget>
+#include "debuggercommand.h"
+#include "commandstatistics.h"
+
+class OCamlDebugEngine;
+
+class OCamlStatistics : public QWidget
+{
+    Q_OBJECT
+
+public:
+    OCamlStatistics( QWidget * parent_p, OCamlDebugEngine *engine_p );
+    virtual ~OCamlStatistics( );
+
+public slots:
+    void commandCompleted( const DebuggerCommand & );
+    void exportStatistics();
+    void resetStatistics();
+
+protected:
+    void closeEvent(QCloseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
+
+private:
+    void updateItem( const QString &kind, const CommandKindStatistics & );
+    static QString histogram( const CommandKindStatistics & );
+    OCamlDebugEngine *_engine_p;
+    QMap<QString,QTreeWidgetItem*> _items;
+    QVBoxLayout *layout_p;
+    QTreeWidget *statistics_p;
+};
+
+#endif
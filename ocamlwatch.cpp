@@ -4,14 +4,16 @@
 #include <QStringListModel>
 #include "ocamlwatch.h"
 #include "textdiff.h"
+#include "debuggerreply.h"
 #include "options.h"
+#include "tracer.h"
 #include <QHeaderView>
 #include <QLineEdit>
+#include <QMenu>
 
 OCamlWatch::OCamlWatch( QWidget *parent_p, int i ) : 
     QWidget(parent_p),
-    id(i),
-    variableRx( "^[^:]* *: ([^=]*[^= ]) *= *([^ ].*)$" )
+    id(i)
 {
     setObjectName(QString("OCamlWatch%1").arg( QString::number(id) ));
 
@@ -125,6 +127,7 @@ QString OCamlWatch::command( const Watch &watch ) const
 
 void OCamlWatch::stopDebugging( const QString &, int , int , bool) 
 {
+    TRACE_SCOPE( "OCamlWatch::stopDebugging" );
     updateWatches();
 }
 
@@ -159,6 +162,7 @@ bool OCamlWatch::displayDiff( const QString & str1, const QString & str2 ) const
 
 void  OCamlWatch::debuggerCommand( const QString &cmd, const QString &result)
 {
+    TRACE_SCOPE( "OCamlWatch::debuggerCommand" );
     for (QList<Watch>::Iterator itWatch = _watches.begin() ; itWatch != _watches.end() ; ++itWatch )
     {
         if ( command( *itWatch ) == cmd && !itWatch->uptodate )
@@ -171,11 +175,7 @@ void  OCamlWatch::debuggerCommand( const QString &cmd, const QString &result)
             itWatch->all_output = value ;
             QStringList item ;
             QString type;
-            if ( variableRx.exactMatch( itWatch->all_output ) )
-            {
-                type = variableRx.cap(1).trimmed();
-                value = variableRx.cap(2).trimmed();
-            }
+            DebuggerReply::parseValue( itWatch->all_output, type, value );
             item << "" << itWatch->variable << type ;
             QTreeWidgetItem *item_p = new QTreeWidgetItem( item );
             item_p->setFlags( Qt::ItemIsEnabled );
@@ -276,6 +276,34 @@ void OCamlWatch::expressionClicked( QTreeWidgetItem *item_p , int column )
 }
 
 
+void OCamlWatch::contextMenuEvent(QContextMenuEvent *event)
+{
+    QTreeWidgetItem *item_p = variables_p->itemAt( variables_p->viewport()->mapFrom( this, event->pos() ) );
+    if ( item_p == NULL )
+        return;
+    variables_p->setCurrentItem( item_p );
+    QMenu menu( this );
+    QAction *findChangeAct = menu.addAction( tr( "Find &change of '%1'" ).arg( item_p->text(1) ), this, SLOT( findChangeOfCurrent() ) );
+    findChangeAct->setStatusTip( tr( "Go back to the time at which the expression got its current value" ) );
+    QAction *runUntilChangeAct = menu.addAction( tr( "&Run until '%1' changes" ).arg( item_p->text(1) ), this, SLOT( runUntilCurrentChanges() ) );
+    runUntilChangeAct->setStatusTip( tr( "Step forward until the value of the expression changes" ) );
+    menu.exec( event->globalPos() );
+}
+
+void OCamlWatch::findChangeOfCurrent()
+{
+    QTreeWidgetItem *item_p = variables_p->currentItem();
+    if ( item_p )
+        emit findChange( item_p->text(1) );
+}
+
+void OCamlWatch::runUntilCurrentChanges()
+{
+    QTreeWidgetItem *item_p = variables_p->currentItem();
+    if ( item_p )
+        emit runUntilChange( item_p->text(1) );
+}
+
 void OCamlWatch::debuggerStarted( bool b )
 {
     setEnabled( b );
@@ -31,6 +31,8 @@ public:
 
 signals:
     bool debugger( const DebuggerCommand & ) ;
+    void findChange( const QString & ) ;
+    void runUntilChange( const QString & ) ;
 public slots:
     void updateWatches();
     void watch( const QString & v, bool display );
@@ -41,8 +43,11 @@ protected slots:
     void columnResized( int logical_index, int old_size, int new_size );
     void addNewValue();
     void expressionClicked( QTreeWidgetItem * , int );
+    void findChangeOfCurrent();
+    void runUntilCurrentChanges();
 protected:
     void closeEvent(QCloseEvent *event);
+    void contextMenuEvent(QContextMenuEvent *event);
 
 private:
     bool displayDiff( const QString & str1, const QString & str2 ) const;
@@ -59,7 +64,6 @@ private:
     QStringList add_values ;
     QCompleter *add_value_completer_p;
     QTreeWidget *variables_p;
-    QRegExp variableRx;
 };
 
 #endif
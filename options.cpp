@@ -7,10 +7,80 @@
 #include <QMainWindow>
 #include <QMdiSubWindow>
 #include <QMdiArea>
+#include <QHash>
+#include <QSet>
+#include <QVariant>
+#include <QTimer>
 #define MAX_UNCLEANED_EXITS 5
+#define FLUSH_DELAY_MS 1000
 
 static long nb_uncleaned_exits = -1;
 static QSettings *settings_p = NULL;
+
+// In-memory copy of the settings: the modified options are written to
+// QSettings by a delayed flush, never in the path of the caller.
+static QHash<QString,QVariant> cache;
+static QSet<QString> dirty;
+static QTimer *flush_timer_p = NULL;
+// Options whose value is only requested when it is read or written,
+// stale until then
+static QHash<QString,const OptionProvider*> providers;
+static QSet<QString> stale;
+
+static void provide( const QString &opt_str )
+{
+    if ( stale.remove( opt_str ) && providers.contains( opt_str ) )
+        cache.insert( opt_str, providers.value( opt_str )->optionValue() );
+}
+
+static void flush()
+{
+    if ( settings_p && !dirty.isEmpty() )
+    {
+        for ( QSet<QString>::const_iterator itOpt = dirty.begin(); itOpt != dirty.end(); ++itOpt )
+        {
+            provide( *itOpt );
+            settings_p->setValue( *itOpt, cache.value( *itOpt ) );
+        }
+        settings_p->sync();
+    }
+    dirty.clear();
+}
+
+static QVariant value( const QString &opt_str, const QVariant &def )
+{
+    provide( opt_str );
+    QHash<QString,QVariant>::iterator itValue = cache.find( opt_str );
+    if ( itValue == cache.end() )
+        itValue = cache.insert( opt_str, settings_p->value( opt_str ) );
+    if ( itValue->isValid() )
+        return *itValue;
+    return def;
+}
+
+static void scheduleFlush()
+{
+    if ( !flush_timer_p )
+    {
+        flush_timer_p = new QTimer();
+        flush_timer_p->setSingleShot( true );
+        flush_timer_p->setInterval( FLUSH_DELAY_MS );
+        QObject::connect( flush_timer_p, &QTimer::timeout, flush );
+    }
+    if ( !flush_timer_p->isActive() )
+        flush_timer_p->start();
+}
+
+static void setValue( const QString &opt_str, const QVariant &val )
+{
+    QHash<QString,QVariant>::iterator itValue = cache.find( opt_str );
+    if ( itValue != cache.end() && itValue->isValid() && *itValue == val )
+        return;
+    cache.insert( opt_str, val );
+    dirty.insert( opt_str );
+    scheduleFlush();
+}
+
 static QString option( const QString &opt )
 {
     QString         opt_str;
@@ -41,6 +111,9 @@ QString Options::read_options ()
     settings_p->setValue ( opt_str, ( int ) nb_uncleaned_exits );
     delete settings_p;
     settings_p = new QSettings( QSettings::IniFormat, QSettings::UserScope, "oqaml", "oqamldebug" );
+    cache.clear();
+    dirty.clear();
+    stale.clear();
     return settings_p->fileName();
 }
 
@@ -48,6 +121,9 @@ QString Options::read_options ()
 void Options::save_options ()
 {
     set_opt( "NB_UNCLEANED_EXITS", ( long )0 );
+    flush();
+    delete          flush_timer_p;
+    flush_timer_p = NULL;
     delete          settings_p;
     settings_p = NULL;
 }
@@ -62,7 +138,7 @@ double Options::get_opt_double ( const QString &opt, double def )
 
     if ( settings_p )
     {
-        val = settings_p->value ( opt_str, def ).toDouble();
+        val = value( opt_str, def ).toDouble();
         return val;
     }
     else
@@ -83,7 +159,7 @@ long Options::get_opt_long ( const QString &opt, long def )
 
     if ( settings_p )
     {
-        val = settings_p->value ( opt_str, static_cast<int>( def ) ).toInt();
+        val = value( opt_str, static_cast<int>( def ) ).toInt();
         return val;
     }
     else
@@ -99,7 +175,7 @@ bool Options::get_opt_bool ( const QString &opt, bool def )
 
     if ( settings_p )
     {
-        result = settings_p->value ( opt_str, def ).toBool();
+        result = value( opt_str, def ).toBool();
         return result;
     }
     else
@@ -129,7 +205,7 @@ QStringList Options::get_opt_strlst ( const QString &opt, const QStringList &def
 
     if ( settings_p )
     {
-        QStringList ret = settings_p->value ( opt_str, def ).toStringList();
+        QStringList ret = value( opt_str, def ).toStringList();
         return ret;
     }
     else
@@ -144,7 +220,7 @@ QByteArray Options::get_opt_array ( const QString &opt, const QByteArray &def )
 
     if ( settings_p )
     {
-        QString ret = settings_p->value ( opt_str, def ).toString();
+        QString ret = value( opt_str, def ).toString();
         return QByteArray::fromHex(ret.toLatin1());
     }
     else
@@ -159,7 +235,7 @@ QString Options::get_opt_str ( const QString &opt, const QString &def )
 
     if ( settings_p )
     {
-        QString ret = settings_p->value ( opt_str, def ).toString();
+        QString ret = value( opt_str, def ).toString();
         return ret;
     }
     else
@@ -171,7 +247,7 @@ void Options::set_opt ( const QString &opt, double val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str,  val );
+        setValue( opt_str,  val );
 }
 
 
@@ -184,7 +260,7 @@ void Options::set_opt ( const QString &opt, long val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str, ( int ) val );
+        setValue( opt_str, ( int ) val );
 }
 
 
@@ -192,21 +268,42 @@ void Options::set_opt ( const QString &opt, const QByteArray &val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str, QString::fromLatin1(val.toHex()) );
+        setValue( opt_str, QString::fromLatin1(val.toHex()) );
 }
 
 void Options::set_opt ( const QString &opt, const QString &val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str, val );
+        setValue( opt_str, val );
 }
 
 void Options::set_opt ( const QString &opt, const QStringList &val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str, val );
+        setValue( opt_str, val );
+}
+
+// The provider is asked for the value at the next flush; it must stay alive
+// until release_opt_lazy()
+void Options::set_opt_lazy ( const QString &opt, const OptionProvider *provider_p )
+{
+    QString         opt_str = option( opt );
+    if ( settings_p )
+    {
+        providers.insert( opt_str, provider_p );
+        stale.insert( opt_str );
+        dirty.insert( opt_str );
+        scheduleFlush();
+    }
+}
+
+void Options::release_opt_lazy ( const QString &opt )
+{
+    QString         opt_str = option( opt );
+    provide( opt_str );
+    providers.remove( opt_str );
 }
 
 void Options::set_opt ( const QString &opt, const QList<int> &val )
@@ -222,7 +319,7 @@ void Options::set_opt ( const QString &opt, bool val )
 {
     QString         opt_str = option( opt );
     if ( settings_p )
-        settings_p->setValue ( opt_str, val );
+        setValue( opt_str, val );
 }
 
 void Options::restore_window_position( const QString &name, QMainWindow *widget_p )
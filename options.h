@@ -8,8 +8,18 @@
 #include <QMainWindow>
 #include <QMdiArea>
 #include <QList>
+#include <QVariant>
 class MainWindow ;
 
+// Value of an option built only when the options are written,
+// for values which are expensive to convert and change often
+class OptionProvider
+{
+  public:
+     virtual ~OptionProvider() {}
+     virtual QVariant optionValue() const = 0;
+};
+
 class Options 
 {
   public:
@@ -37,5 +47,7 @@ class Options
      static void            set_opt (const QString&,const  QStringList &);
      static void            set_opt (const QString&,const  QList<int> &);
      static void            set_opt (const QString&,const  QByteArray &);
+     static void            set_opt_lazy (const QString&,const OptionProvider *);
+     static void            release_opt_lazy (const QString&);
 };
 #endif
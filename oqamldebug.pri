@@ -0,0 +1,6 @@
+VERSION=0.9.4
+DEFINES += VERSION=\\\"$$VERSION\\\"
+
+isEmpty(PREFIX_BIN) {
+ PREFIX_BIN = bin
+}
@@ -0,0 +1,213 @@
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTextStream>
+#include <QStringList>
+#include "textdiff.h"
+#include "ocamlsourcehighlighter.h"
+#include "ocamldebughighlighter.h"
+#include "ocamldebugengine.h"
+#include "ocamlsource.h"
+#include "ocamlstack.h"
+#include "debuggerreply.h"
+
+static QString generateOCamlSource( int lines )
+{
+    QString source;
+    QTextStream out( &source );
+    for ( int i = 0; i < lines; i++ )
+    {
+        switch ( i % 8 )
+        {
+            case 0: out << "(* function number " << i << " *)\n"; break;
+            case 1: out << "let rec f" << i << " x y =\n"; break;
+            case 2: out << "  if x > " << i << " then \"string " << i << "\" else\n"; break;
+            case 3: out << "  match y with\n"; break;
+            case 4: out << "  | Some v -> List.map (fun a -> a + v) [ 1; 2; 3 ]\n"; break;
+            case 5: out << "  | None -> raise Not_found\n"; break;
+            case 6: out << "  ; Printf.printf \"%d\\n\" " << i << "\n"; break;
+            default: out << "\n"; break;
+        }
+    }
+    return source;
+}
+
+static QString generateBacktrace( int frames )
+{
+    QString result;
+    QTextStream out( &result );
+    out << "Backtrace:\n";
+    for ( int i = 0; i < frames; i++ )
+        out << "#" << i << "  Pc : " << ( 1000 + i * 12 ) << "  Module" << ( i % 17 ) << " char " << ( i * 31 ) << "\n";
+    return result;
+}
+
+static QByteArray generateTranscript( int steps )
+{
+    QByteArray transcript;
+    transcript += "\tOCaml Debugger version 4.02.3\n\n(ocd) ";
+    transcript += "Loading program... done.\n(ocd) ";
+    transcript += "Breakpoint 1 at 14500: file test.ml, line 12, characters 3-25\n(ocd) ";
+    for ( int i = 0; i < steps; i++ )
+    {
+        transcript += "Time : " + QByteArray::number( i + 1 ) + " - pc : " + QByteArray::number( 14000 + i * 4 ) + " - module Test\n";
+        if ( i % 25 == 0 )
+            transcript += "Breakpoint : 1\n";
+        transcript += "\x1A\x1AM" "test.ml:" + QByteArray::number( i * 10 ) + ":" + QByteArray::number( i * 10 + 8 ) + ":before\n";
+        transcript += "(ocd) ";
+        if ( i % 10 == 0 )
+            transcript += "x : int = " + QByteArray::number( i ) + "\n(ocd) ";
+    }
+    return transcript;
+}
+
+static QString generateRecord( int length )
+{
+    QString record;
+    for ( int i = 0; record.length() < length; i++ )
+        record += QString( "{ field%1 = %2; text = \"value %3\" }; " ).arg( i ).arg( i * 7 ).arg( i % 13 );
+    return record;
+}
+
+// Micro-benchmarks of the text diff, the highlighters, the ocamldebug output
+// parsing, the source window and the stack window on generated inputs.
+class OQamlDebugBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void textDiff_data();
+    void textDiff();
+    void highlightSource();
+    void highlightDebug();
+    void engineTranscript();
+    void sourceLoadFile();
+    void sourceStopDebugging();
+    void stackParseBacktrace();
+    void stackBacktrace();
+
+private:
+    QTemporaryDir _temp_dir;
+    QString _source_file;
+    QString _source;
+    QByteArray _transcript;
+    QString _backtrace;
+};
+
+void OQamlDebugBench::initTestCase()
+{
+    QString transcript_file = QString::fromLocal8Bit( qgetenv( "OQAMLDEBUG_BENCH_TRANSCRIPT" ) );
+    if ( transcript_file.isEmpty() )
+        _transcript = generateTranscript( 2000 );
+    else
+    {
+        QFile f( transcript_file );
+        QVERIFY2( f.open( QFile::ReadOnly ), qPrintable( "Unable to read the transcript '" + transcript_file + "'." ) );
+        _transcript = f.readAll();
+    }
+
+    QVERIFY( _temp_dir.isValid() );
+    _source_file = _temp_dir.path() + "/bench.ml";
+    _source = generateOCamlSource( 50000 );
+    QFile f( _source_file );
+    QVERIFY2( f.open( QFile::WriteOnly | QFile::Text ), qPrintable( "Unable to write '" + _source_file + "'." ) );
+    f.write( _source.toUtf8() );
+    f.close();
+
+    _backtrace = generateBacktrace( 500 );
+}
+
+void OQamlDebugBench::textDiff_data()
+{
+    QTest::addColumn<int>( "length" );
+    QTest::newRow( "watch" ) << 80;
+    QTest::newRow( "huge" ) << 20000;
+}
+
+void OQamlDebugBench::textDiff()
+{
+    QFETCH( int, length );
+    QString ref = generateRecord( length );
+    QString cur = ref;
+    for ( int i = 0; i < cur.length(); i += 97 )
+        cur[i] = QChar( 'X' );
+    QBENCHMARK
+    {
+        htmlDiff( cur, ref );
+    }
+}
+
+void OQamlDebugBench::highlightSource()
+{
+    QTextDocument document;
+    document.setPlainText( _source );
+    OCamlSourceHighlighter highlighter( &document );
+    QBENCHMARK
+    {
+        highlighter.rehighlight();
+    }
+}
+
+void OQamlDebugBench::highlightDebug()
+{
+    QTextDocument document;
+    document.setPlainText( QString::fromUtf8( _transcript ) );
+    OCamlDebugHighlighter highlighter( &document );
+    QBENCHMARK
+    {
+        highlighter.rehighlight();
+    }
+}
+
+void OQamlDebugBench::engineTranscript()
+{
+    OCamlDebugEngine engine( NULL, QString(), Arguments( QStringList() << "a.out" ), QString() );
+    QBENCHMARK
+    {
+        engine.processOutput( _transcript );
+    }
+}
+
+void OQamlDebugBench::sourceLoadFile()
+{
+    OCamlSource source;
+    QBENCHMARK
+    {
+        source.loadFile( _source_file );
+    }
+}
+
+void OQamlDebugBench::sourceStopDebugging()
+{
+    OCamlSource source;
+    source.loadFile( _source_file );
+    int length = source.document()->characterCount();
+    int position = 0;
+    QBENCHMARK
+    {
+        position = ( position + 7919 ) % ( length - 20 );
+        source.stopDebugging( _source_file, position, position + 10, false );
+    }
+}
+
+void OQamlDebugBench::stackParseBacktrace()
+{
+    QBENCHMARK
+    {
+        DebuggerReply::parseBacktrace( _backtrace );
+    }
+}
+
+void OQamlDebugBench::stackBacktrace()
+{
+    OCamlStack stack( NULL );
+    QBENCHMARK
+    {
+        stack.debuggerCommand( "backtrace", _backtrace );
+    }
+}
+
+QTEST_MAIN( OQamlDebugBench )
+#include "oqamldebugbench.moc"
@@ -0,0 +1,15 @@
+include(oqamldebug.pri)
+include(oqamldebugcore.pri)
+include(oqamldebuggui.pri)
+
+QT           += testlib
+
+TEMPLATE      = app
+CONFIG       += console
+CONFIG       -= app_bundle
+TARGET        = oqamldebug-bench
+OBJECTS_DIR   = .obj/bench
+MOC_DIR       = .moc/bench
+RCC_DIR       = .rcc/bench
+
+SOURCES      += oqamldebugbench.cpp
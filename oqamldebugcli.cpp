@@ -0,0 +1,69 @@
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTimer>
+#include <stdio.h>
+#include "arguments.h"
+#include "ocamldebugengine.h"
+#include "ocamldebugscript.h"
+
+static void usage( const char *program )
+{
+    fprintf( stderr,
+            "OQamlDebug command line driver %s\n"
+            "Usage: %s [-v] [-ocamldebug <executable>] [-o <statistics.csv|statistics.json>] <script> <ocamldebug arguments>\n"
+            "Executes each line of <script> as an ocamldebug command and prints timing statistics.\n",
+            VERSION, program );
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    bool verbose = false;
+    QString ocamldebug = QStandardPaths::findExecutable( "ocamldebug" );
+    QString script;
+    QString statistics_file;
+    QStringList arguments;
+    for (int i=1; i< argc ; i++)
+    {
+        QString arg = QString::fromLocal8Bit( argv[i] );
+        if ( script.isEmpty() && arg == "-v" )
+            verbose = true;
+        else if ( script.isEmpty() && arg == "-ocamldebug" && i+1 < argc )
+            ocamldebug = QString::fromLocal8Bit( argv[++i] );
+        else if ( script.isEmpty() && arg == "-o" && i+1 < argc )
+            statistics_file = QString::fromLocal8Bit( argv[++i] );
+        else if ( script.isEmpty() )
+            script = arg;
+        else
+            arguments << arg;
+    }
+
+    if ( script.isEmpty() || arguments.isEmpty() )
+    {
+        usage( argv[0] );
+        return 2;
+    }
+    if ( ocamldebug.isEmpty() )
+    {
+        fprintf( stderr, "OCamlDebug executable could not be found into the executable path!\n" );
+        return 2;
+    }
+
+    bool ok;
+    QStringList commands = OCamlDebugScript::readScript( script, &ok );
+    if ( !ok )
+    {
+        fprintf( stderr, "Unable to read the script '%s'.\n", qPrintable( script ) );
+        return 2;
+    }
+
+    OCamlDebugEngine engine( NULL, ocamldebug, Arguments( arguments ), QString() );
+    OCamlDebugScript driver( &engine, commands, verbose, statistics_file );
+    QObject::connect( &driver, SIGNAL( finished( int ) ), &app, SLOT( quit() ), Qt::QueuedConnection );
+    QTimer::singleShot( 0, &driver, SLOT( start() ) );
+    app.exec();
+
+    return driver.exitCode();
+}
@@ -0,0 +1,19 @@
+include(oqamldebug.pri)
+include(oqamldebugcore.pri)
+
+TEMPLATE      = app
+CONFIG       += console
+CONFIG       -= app_bundle
+QT           -= gui
+TARGET        = oqamldebug-cli
+OBJECTS_DIR   = .obj/cli
+MOC_DIR       = .moc/cli
+
+HEADERS       = ocamldebugscript.h
+SOURCES       = ocamldebugscript.cpp \
+                oqamldebugcli.cpp
+
+unix {
+    target.path = $$PREFIX_BIN
+    INSTALLS += target
+}
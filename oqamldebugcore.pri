@@ -0,0 +1,12 @@
+# Link against the widget-free debugger core (oqamldebugcore.pro)
+QT += network
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+win32:CONFIG(release, debug|release): OQAMLDEBUGCORE_DIR = $$OUT_PWD/release
+else:win32:CONFIG(debug, debug|release): OQAMLDEBUGCORE_DIR = $$OUT_PWD/debug
+else: OQAMLDEBUGCORE_DIR = $$OUT_PWD
+
+LIBS += -L$$OQAMLDEBUGCORE_DIR -loqamldebugcore
+win32-msvc*: PRE_TARGETDEPS += $$OQAMLDEBUGCORE_DIR/oqamldebugcore.lib
+else: PRE_TARGETDEPS += $$OQAMLDEBUGCORE_DIR/liboqamldebugcore.a
@@ -0,0 +1,33 @@
+include(oqamldebug.pri)
+
+TEMPLATE      = lib
+CONFIG       += staticlib
+QT            = core network
+TARGET        = oqamldebugcore
+OBJECTS_DIR   = .obj/core
+MOC_DIR       = .moc/core
+
+HEADERS       = arguments.h \
+                breakpoint.h \
+                breakpointindex.h \
+                commandhistory.h \
+                commandstatistics.h \
+                debuggercommand.h \
+                debuggerreply.h \
+                filesystemwatcher.h \
+                filewatchservice.h \
+                moduleindex.h \
+                ocamldebugengine.h \
+                tracer.h \
+                valuesearch.h
+SOURCES       = arguments.cpp \
+                breakpointindex.cpp \
+                commandhistory.cpp \
+                commandstatistics.cpp \
+                debuggerreply.cpp \
+                filesystemwatcher.cpp \
+                filewatchservice.cpp \
+                moduleindex.cpp \
+                ocamldebugengine.cpp \
+                tracer.cpp \
+                valuesearch.cpp
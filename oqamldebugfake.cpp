@@ -0,0 +1,269 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <stdio.h>
+
+// Stand-in for ocamldebug which speaks enough of its text protocol
+// to drive OQamlDebug without an OCaml toolchain.
+// It is configured through the environment because OQamlDebug starts it
+// with the ocamldebug command line:
+//   OQAMLDEBUG_FAKE_SOURCE     source file reported in the location lines
+//   OQAMLDEBUG_FAKE_TRANSCRIPT recorded ocamldebug output replayed instead of the generated answers
+//   OQAMLDEBUG_FAKE_RATE       maximal number of answers per second (0: unlimited)
+class FakeOCamlDebug
+{
+public:
+    FakeOCamlDebug( const QString &source, const QByteArray &transcript, int rate );
+    bool command( const QString & );
+    void banner();
+
+private:
+    void reply( const QByteArray & );
+    QByteArray location() const;
+    QByteArray timeInfo() const;
+    QByteArray move( int steps );
+    QByteArray breakpoint( const QString & );
+    QByteArray removeBreakpoint( const QString & );
+    QByteArray backtrace( int frames ) const;
+    QByteArray frame( int ) const;
+    QByteArray print( const QString & ) const;
+
+    QByteArray _source;
+    QString _module;
+    QList<int> _lines;
+    QList<QByteArray> _transcript;
+    int _transcript_position;
+    int _rate;
+    int _time;
+    int _frame;
+    int _next_breakpoint;
+    QMap<int,int> _breakpoints;
+};
+
+FakeOCamlDebug::FakeOCamlDebug( const QString &source, const QByteArray &transcript, int rate ) :
+    _transcript_position( 0 ),
+    _rate( rate ),
+    _time( 0 ),
+    _frame( 0 ),
+    _next_breakpoint( 1 )
+{
+    QFileInfo source_info( source );
+    _source = source_info.absoluteFilePath().toLocal8Bit();
+    _module = source_info.baseName();
+    if ( !_module.isEmpty() )
+        _module[0] = _module[0].toUpper();
+
+    QFile f( source );
+    if ( f.open( QFile::ReadOnly ) )
+    {
+        QByteArray text = f.readAll();
+        int pos = 0;
+        while ( pos < text.length() )
+        {
+            int end = text.indexOf( '\n', pos );
+            if ( end < 0 )
+                end = text.length();
+            if ( end > pos )
+                _lines << pos;
+            pos = end + 1;
+        }
+    }
+    if ( _lines.isEmpty() )
+        _lines << 0;
+
+    const QByteArray prompt = "(ocd) ";
+    int pos = 0;
+    while ( pos < transcript.length() )
+    {
+        int end = transcript.indexOf( prompt, pos );
+        if ( end < 0 )
+            end = transcript.length();
+        _transcript << transcript.mid( pos, end - pos );
+        pos = end + prompt.length();
+    }
+}
+
+void FakeOCamlDebug::reply( const QByteArray &answer )
+{
+    if ( _rate > 0 )
+        QThread::msleep( 1000 / _rate );
+    fwrite( answer.constData(), 1, answer.size(), stdout );
+    fputs( "(ocd) ", stdout );
+    fflush( stdout );
+}
+
+void FakeOCamlDebug::banner()
+{
+    if ( !_transcript.isEmpty() )
+    {
+        QByteArray first = _transcript.at( _transcript_position++ );
+        fwrite( first.constData(), 1, first.size(), stdout );
+        fputs( "(ocd) ", stdout );
+        fflush( stdout );
+    }
+    else
+        reply( "\tOCaml Debugger version (oqamldebug-fake)\n\n" );
+}
+
+QByteArray FakeOCamlDebug::timeInfo() const
+{
+    return "Time : " + QByteArray::number( _time ) + " - pc : " + QByteArray::number( 10000 + _time * 4 ) + " - module " + _module.toLocal8Bit() + "\n";
+}
+
+QByteArray FakeOCamlDebug::location() const
+{
+    int start = _lines.at( _time % _lines.count() );
+    return "\x1A\x1AM" + _source + ":" + QByteArray::number( start ) + ":" + QByteArray::number( start + 1 ) + ( _time % 2 ? ":after" : ":before" ) + "\n";
+}
+
+QByteArray FakeOCamlDebug::move( int steps )
+{
+    _time = qMax( 0, _time + steps );
+    _frame = 0;
+    QByteArray answer = timeInfo();
+    if ( _time == 0 )
+        return answer + "Beginning of program.\n";
+    if ( !_breakpoints.isEmpty() && qAbs( steps ) > 1 )
+        answer += "Breakpoint : " + QByteArray::number( _breakpoints.begin().key() ) + "\n";
+    return answer + location();
+}
+
+QByteArray FakeOCamlDebug::breakpoint( const QString &cmd )
+{
+    QStringList args = cmd.split( ' ', QString::SkipEmptyParts );
+    int line = 1, column = 0;
+    if ( args.count() >= 4 && args.at(1) == "@" )
+    {
+        line = args.at(3).toInt();
+        if ( args.count() >= 5 )
+            column = args.at(4).toInt();
+    }
+    int id = _next_breakpoint++;
+    _breakpoints[ id ] = line;
+    return "Breakpoint " + QByteArray::number( id ) + " at " + QByteArray::number( 10000 + id * 12 ) + ": file "
+        + _source + ", line " + QByteArray::number( line )
+        + ", characters " + QByteArray::number( column ) + "-" + QByteArray::number( column + 10 ) + "\n";
+}
+
+QByteArray FakeOCamlDebug::removeBreakpoint( const QString &cmd )
+{
+    QByteArray answer;
+    QStringList args = cmd.split( ' ', QString::SkipEmptyParts );
+    for ( int i = 1; i < args.count(); i++ )
+    {
+        int id = args.at(i).toInt();
+        if ( _breakpoints.remove( id ) )
+            answer += "Removed breakpoint " + QByteArray::number( id ) + " at " + QByteArray::number( 10000 + id * 12 ) + " : file " + _source + "\n";
+    }
+    return answer;
+}
+
+QByteArray FakeOCamlDebug::frame( int frame ) const
+{
+    return "#" + QByteArray::number( frame ) + "  Pc : " + QByteArray::number( 10000 + _time * 4 + frame * 40 )
+        + "  " + _module.toLocal8Bit() + " char " + QByteArray::number( _lines.at( ( _time + frame ) % _lines.count() ) ) + "\n";
+}
+
+QByteArray FakeOCamlDebug::backtrace( int frames ) const
+{
+    QByteArray answer = "Backtrace:\n";
+    for ( int i = 0; i < frames; i++ )
+        answer += frame( i );
+    return answer;
+}
+
+QByteArray FakeOCamlDebug::print( const QString &cmd ) const
+{
+    QByteArray answer;
+    QStringList args = cmd.split( ' ', QString::SkipEmptyParts );
+    for ( int i = 1; i < args.count(); i++ )
+        answer += args.at(i).toLocal8Bit() + " : int = " + QByteArray::number( _time * ( i + 1 ) ) + "\n";
+    return answer;
+}
+
+bool FakeOCamlDebug::command( const QString &line )
+{
+    QString cmd = line.simplified();
+    QString kind = cmd.section( ' ', 0, 0 );
+    QString arg = cmd.section( ' ', 1, 1 );
+
+    if ( kind == "quit" || kind == "q" )
+        return false;
+
+    if ( !_transcript.isEmpty() )
+    {
+        if ( _transcript_position >= _transcript.count() )
+            _transcript_position = _transcript.count() > 1 ? 1 : 0;
+        reply( _transcript.at( _transcript_position++ ) );
+        return true;
+    }
+
+    int count = arg.isEmpty() ? 1 : arg.toInt();
+    if ( kind == "step" || kind == "s" || kind == "next" || kind == "n" )
+        reply( move( count ) );
+    else if ( kind == "backstep" || kind == "bs" || kind == "previous" || kind == "prev" )
+        reply( move( -count ) );
+    else if ( kind == "run" || kind == "r" || kind == "finish" )
+        reply( move( 50 ) );
+    else if ( kind == "reverse" || kind == "rev" || kind == "start" )
+        reply( move( -50 ) );
+    else if ( kind == "goto" )
+        reply( move( arg.toInt() - _time ) );
+    else if ( kind == "break" || kind == "b" )
+        reply( breakpoint( cmd ) );
+    else if ( kind == "delete" || kind == "del" || kind == "d" )
+        reply( removeBreakpoint( cmd ) );
+    else if ( kind == "backtrace" || kind == "bt" )
+        reply( backtrace( arg.isEmpty() ? 20 : qAbs( count ) ) );
+    else if ( kind == "print" || kind == "p" || kind == "display" )
+        reply( print( cmd ) );
+    else if ( kind == "up" )
+        reply( frame( ++_frame ) + location() );
+    else if ( kind == "down" )
+        reply( frame( _frame = qMax( 0, _frame - 1 ) ) + location() );
+    else if ( kind == "frame" || kind == "fr" )
+        reply( frame( _frame = ( arg.isEmpty() ? _frame : count ) ) + location() );
+    else
+        reply( QByteArray() );
+    return true;
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    QString source = QString::fromLocal8Bit( qgetenv( "OQAMLDEBUG_FAKE_SOURCE" ) );
+    if ( source.isEmpty() && argc > 1 )
+        source = QFileInfo( QString::fromLocal8Bit( argv[argc-1] ) ).completeBaseName() + ".ml";
+    if ( source.isEmpty() )
+        source = "fake.ml";
+
+    QByteArray transcript;
+    QString transcript_file = QString::fromLocal8Bit( qgetenv( "OQAMLDEBUG_FAKE_TRANSCRIPT" ) );
+    if ( !transcript_file.isEmpty() )
+    {
+        QFile f( transcript_file );
+        if ( !f.open( QFile::ReadOnly ) )
+        {
+            fprintf( stderr, "Unable to read the transcript '%s'.\n", qPrintable( transcript_file ) );
+            return 2;
+        }
+        transcript = f.readAll();
+    }
+
+    FakeOCamlDebug debugger( source, transcript, qgetenv( "OQAMLDEBUG_FAKE_RATE" ).toInt() );
+    debugger.banner();
+
+    char buffer[4096];
+    while ( fgets( buffer, sizeof( buffer ), stdin ) )
+    {
+        if ( !debugger.command( QString::fromLocal8Bit( buffer ) ) )
+            break;
+    }
+    return 0;
+}
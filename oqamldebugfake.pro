@@ -0,0 +1,11 @@
+include(oqamldebug.pri)
+
+TEMPLATE      = app
+CONFIG       += console
+CONFIG       -= app_bundle
+QT           -= gui
+TARGET        = oqamldebug-fake
+OBJECTS_DIR   = .obj/fake
+MOC_DIR       = .moc/fake
+
+SOURCES       = oqamldebugfake.cpp
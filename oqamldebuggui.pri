@@ -0,0 +1,37 @@
+# Widgets shared by the GUI and the benchmarks (oqamldebugbench.pro)
+QT += widgets
+
+HEADERS      += mainwindow.h \
+                textdiff.h \
+                ocamlsourcehighlighter.h \
+                ocamldebughighlighter.h \
+                ocamldebug.h \
+                ocamlwatch.h \
+                ocamlstack.h \
+                ocamlstatistics.h \
+                ocamllogpoints.h \
+                ocamlrun.h \
+                ocamlbreakpoint.h \
+                breakpointmodel.h \
+                highlighter.h \
+                options.h \
+                stressharness.h \
+                updatescheduler.h \
+                ocamlsource.h
+SOURCES      += textdiff.cpp \
+                ocamlrun.cpp \
+                ocamlbreakpoint.cpp \
+                breakpointmodel.cpp \
+                ocamlstack.cpp \
+                ocamlstatistics.cpp \
+                ocamllogpoints.cpp \
+                ocamlsourcehighlighter.cpp \
+                ocamldebughighlighter.cpp \
+                ocamlwatch.cpp \
+                ocamldebug.cpp \
+                mainwindow.cpp \
+                options.cpp \
+                stressharness.cpp \
+                updatescheduler.cpp \
+                ocamlsource.cpp
+RESOURCES    += oqamldebug.qrc
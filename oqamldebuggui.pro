@@ -0,0 +1,34 @@
+include(oqamldebug.pri)
+include(oqamldebugcore.pri)
+include(oqamldebuggui.pri)
+
+CONFIG -= app_bundle
+TARGET        = oqamldebug
+OBJECTS_DIR   = .obj/gui
+MOC_DIR       = .moc/gui
+RCC_DIR       = .rcc/gui
+
+SOURCES      += main.cpp
+FORMS         =
+
+ICON=images/oqamldebug.icns
+
+# install
+DISTFILES += oqamldebug.qrc readme.html 
+DISTFILES += images/copy.png images/oqamldebug.png images/cut.png images/debug-backstep.png images/debug-down.png \
+                 images/debug-finish.png images/debugger.png images/debug-interrupt.png \
+                 images/debug-next.png images/debug-previous.png images/debug-reverse.png \
+                 images/debug-run.png images/debug-step.png images/debug-up.png \
+                 images/open.png images/delete.png images/paste.png
+
+unix {
+    target.target = $$PREFIX_BIN/$$TARGET
+    target.path = $$PREFIX_BIN
+    target.depends = $$TARGET
+    INSTALLS += target
+
+    tags.target = tags
+    tags.commands = ctags  --line-directives=yes --languages=all --fields=iaS --extra=+q --langmap=yacc:.y,c++:.cpp.h,c:.c --yacc-kinds=+l --c-kinds=+dpefglmstuv --c++-kinds=+cpdefmstuv -f $$tags.target  $$HEADERS $$SOURCES
+    tags.depends = $$HEADERS $$SOURCES
+    QMAKE_EXTRA_TARGETS += tags
+}
@@ -0,0 +1,145 @@
+#include <QApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+#include <stdio.h>
+#include "stressharness.h"
+#include "ocamldebug.h"
+#include "ocamlsource.h"
+
+StressHarness::StressHarness( QObject *parent_p, OCamlDebug *ocamldebug_p, int steps, const QString &report ) : QObject( parent_p ),
+    _ocamldebug_p( ocamldebug_p ),
+    _steps( steps ),
+    _steps_sent( 0 ),
+    _missed_paints( 0 ),
+    _stop_pending( false ),
+    _waiting_paint( false ),
+    _finished( false ),
+    _report( report )
+{
+    _latencies.reserve( steps );
+    _paint_timeout.setSingleShot( true );
+    _paint_timeout.setInterval( 1000 );
+    connect( &_paint_timeout, SIGNAL( timeout() ), this, SLOT( paintTimeout() ) );
+    connect( this, SIGNAL( debugger( const DebuggerCommand & ) ), _ocamldebug_p, SLOT( debugger( const DebuggerCommand & ) ) );
+    connect( _ocamldebug_p->engine(), SIGNAL( stopDebugging( const QString &, int , int , bool) ), this, SLOT( engineStopDebugging( const QString &, int , int , bool) ) );
+    connect( _ocamldebug_p, SIGNAL( stopDebugging( const QString &, int , int , bool) ), this, SLOT( stopDebugging( const QString &, int , int , bool) ) );
+    connect( _ocamldebug_p, SIGNAL( debuggerCommand( const QString &, const QString & ) ), this, SLOT( debuggerCommand( const QString &, const QString & ) ) );
+    qApp->installEventFilter( this );
+    _run_timer.start();
+    scheduleNextStep();
+}
+
+int StressHarness::requestedSteps()
+{
+    return qgetenv( "OQAMLDEBUG_STRESS_STEPS" ).toInt();
+}
+
+QString StressHarness::requestedReport()
+{
+    return QString::fromLocal8Bit( qgetenv( "OQAMLDEBUG_STRESS_REPORT" ) );
+}
+
+// The latency is measured from the first stop parsed by the engine since the
+// last one delivered to the panes, so that the deferred delivery is included
+void StressHarness::engineStopDebugging( const QString &file, int , int , bool )
+{
+    if ( file.isEmpty() || _finished || _stop_pending )
+        return;
+    _stop_pending = true;
+    _stop_timer.start();
+}
+
+void StressHarness::stopDebugging( const QString &file, int , int , bool )
+{
+    if ( file.isEmpty() || _finished || !_stop_pending )
+        return;
+    _stop_pending = false;
+    _waiting_paint = true;
+    _paint_timeout.start();
+}
+
+bool StressHarness::eventFilter( QObject *watched_p, QEvent *event_p )
+{
+    if ( _waiting_paint && event_p->type() == QEvent::Paint )
+    {
+        OCamlSource *source_p = qobject_cast<OCamlSource*>( watched_p->parent() );
+        if ( source_p && source_p->viewport() == watched_p )
+        {
+            _latencies.append( _stop_timer.nsecsElapsed() );
+            _waiting_paint = false;
+            _paint_timeout.stop();
+            scheduleNextStep();
+        }
+    }
+    return QObject::eventFilter( watched_p, event_p );
+}
+
+void StressHarness::paintTimeout()
+{
+    _missed_paints++;
+    _waiting_paint = false;
+    scheduleNextStep();
+}
+
+void StressHarness::debuggerCommand( const QString &, const QString & )
+{
+    scheduleNextStep();
+}
+
+void StressHarness::scheduleNextStep()
+{
+    QTimer::singleShot( 0, this, SLOT( nextStep() ) );
+}
+
+void StressHarness::nextStep()
+{
+    if ( _finished || _waiting_paint || !_ocamldebug_p->engine()->isCommandQueueEmpty() )
+        return;
+
+    if ( _steps_sent >= _steps )
+    {
+        _finished = true;
+        report();
+        qApp->quit();
+        return;
+    }
+
+    _steps_sent++;
+    emit debugger( DebuggerCommand( "step", DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
+}
+
+void StressHarness::report()
+{
+    QVector<qint64> latencies = _latencies;
+    std::sort( latencies.begin(), latencies.end() );
+    double ms = 1000000.0;
+    QJsonObject result;
+    result["steps"] = _steps_sent;
+    result["stops"] = latencies.count();
+    result["missed_paints"] = _missed_paints;
+    result["duration_ms"] = double( _run_timer.elapsed() );
+    if ( !latencies.isEmpty() )
+    {
+        qint64 sum = 0;
+        for ( QVector<qint64>::const_iterator itLatency = latencies.begin(); itLatency != latencies.end(); ++itLatency )
+            sum += *itLatency;
+        result["mean_ms"] = sum / ms / latencies.count();
+        result["p50_ms"] = latencies.at( latencies.count() * 50 / 100 ) / ms;
+        result["p90_ms"] = latencies.at( latencies.count() * 90 / 100 ) / ms;
+        result["p99_ms"] = latencies.at( latencies.count() * 99 / 100 ) / ms;
+        result["max_ms"] = latencies.last() / ms;
+    }
+
+    QByteArray json = QJsonDocument( result ).toJson();
+    fwrite( json.constData(), 1, json.size(), stdout );
+    fflush( stdout );
+    if ( !_report.isEmpty() )
+    {
+        QFile f( _report );
+        if ( f.open( QFile::WriteOnly ) )
+            f.write( json );
+    }
+}
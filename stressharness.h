@@ -0,0 +1,55 @@
+#ifndef STRESSHARNESS_H
+#define STRESSHARNESS_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "debuggercommand.h"
+
+class OCamlDebug;
+
+// Drives the debugger through a fixed number of steps and measures the time
+// between each stop parsed by the engine and the repaint of the source window.
+// Enabled with OQAMLDEBUG_STRESS_STEPS, typically against oqamldebug-fake.
+class StressHarness : public QObject
+{
+    Q_OBJECT
+
+public:
+    StressHarness( QObject *parent_p, OCamlDebug *ocamldebug_p, int steps, const QString &report );
+    static int requestedSteps();
+    static QString requestedReport();
+
+signals:
+    void debugger( const DebuggerCommand & );
+
+protected:
+    bool eventFilter( QObject *watched_p, QEvent *event_p );
+
+private slots:
+    void engineStopDebugging( const QString &, int , int , bool );
+    void stopDebugging( const QString &, int , int , bool );
+    void debuggerCommand( const QString &, const QString & );
+    void nextStep();
+    void paintTimeout();
+
+private:
+    void scheduleNextStep();
+    void report();
+    OCamlDebug *_ocamldebug_p;
+    int _steps;
+    int _steps_sent;
+    int _missed_paints;
+    bool _stop_pending;
+    bool _waiting_paint;
+    bool _finished;
+    QString _report;
+    QElapsedTimer _stop_timer;
+    QElapsedTimer _run_timer;
+    QTimer _paint_timeout;
+    QVector<qint64> _latencies;
+};
+
+#endif
@@ -622,4 +622,87 @@ QString htmlDiff( const QString &cur, const QString &ref )
     return ret;
 }
 
+QList<LineDiffHunk> lineDiff( const QStringList &cur, const QStringList &ref )
+{
+    QList<LineDiffHunk> hunks;
+
+    // common prefix and suffix are not part of the LCS
+    int start = 0;
+    int lg = qMin( cur.count(), ref.count() );
+    while ( start < lg && cur.at( start ) == ref.at( start ) )
+        start++;
+    int end = 0;
+    while ( end < lg - start && cur.at( cur.count() - 1 - end ) == ref.at( ref.count() - 1 - end ) )
+        end++;
+
+    int lgX = ref.count() - start - end;
+    int lgY = cur.count() - start - end;
+    if ( lgX == 0 && lgY == 0 )
+        return hunks;
+
+    // 2 bits per cell, larger changes are replaced in one piece
+    static const unsigned long long max_cells = 64*1024*1024;
+    if ( lgX == 0 || lgY == 0 || (unsigned long long)( lgX + 1 ) * ( lgY + 1 ) > max_cells )
+    {
+        hunks.append( LineDiffHunk( start, lgX, start, lgY ) );
+        return hunks;
+    }
+
+    QHash<QString,int> line_table;
+    QVector<LCSItem> X( lgX );
+    QVector<LCSItem> Y( lgY );
+    for ( int i = 0; i < lgX; i++ )
+    {
+        const QString &line = ref.at( start + i );
+        X[i].setIndex( line_table.value( line, line_table.count() ) );
+        line_table.insert( line, X[i].index() );
+    }
+    for ( int j = 0; j < lgY; j++ )
+    {
+        const QString &line = cur.at( start + j );
+        Y[j].setIndex( line_table.value( line, line_table.count() ) );
+        line_table.insert( line, Y[j].index() );
+    }
+
+    LCSMatrix b( lgX + 1, lgY + 1 );
+    if ( !b.allocated() )
+    {
+        hunks.append( LineDiffHunk( start, lgX, start, lgY ) );
+        return hunks;
+    }
+    calcLCS( X, Y, b );
 
+    int i = lgX;
+    int j = lgY;
+    int ref_end = -1;
+    int cur_end = -1;
+    for (;;)
+    {
+        LCSMarker depl = b.get( i, j );
+        if ( depl == ARROW_UP_LEFT || depl == FINAL )
+        {
+            if ( ref_end >= 0 )
+            {
+                hunks.prepend( LineDiffHunk( start + i, ref_end - i, start + j, cur_end - j ) );
+                ref_end = -1;
+            }
+            if ( depl == FINAL )
+                break;
+            i--;
+            j--;
+        }
+        else
+        {
+            if ( ref_end < 0 )
+            {
+                ref_end = i;
+                cur_end = j;
+            }
+            if ( depl == ARROW_UP )
+                i--;
+            else
+                j--;
+        }
+    }
+    return hunks;
+}
@@ -1,8 +1,22 @@
 #ifndef TEXTDIFF_H
 #define TEXTDIFF_H
 #include <QString>
+#include <QStringList>
+#include <QList>
 
 QString htmlDiff( const QString &cur, const QString &ref );
 
+// The lines [refLine, refLine+refCount) of the reference are replaced
+// by the lines [curLine, curLine+curCount) of the current text.
+struct LineDiffHunk
+{
+    LineDiffHunk( int ref_line, int ref_count, int cur_line, int cur_count ) :
+        refLine( ref_line ), refCount( ref_count ), curLine( cur_line ), curCount( cur_count ) { }
+    int refLine, refCount;
+    int curLine, curCount;
+};
+
+QList<LineDiffHunk> lineDiff( const QStringList &cur, const QStringList &ref );
+
 #endif
 
@@ -0,0 +1,65 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+#include <QTextStream>
+
+bool Tracer::_enabled = false;
+QElapsedTimer Tracer::_clock;
+QString Tracer::_file_name;
+QVector<Tracer::Span> Tracer::_spans;
+
+void Tracer::start( const QString &file_name )
+{
+    _file_name = file_name;
+    _spans.clear();
+    _spans.reserve( 65536 );
+    _clock.start();
+    _enabled = true;
+}
+
+void Tracer::startFromEnvironment()
+{
+    QString file_name = QString::fromLocal8Bit( qgetenv( "OQAMLDEBUG_TRACE" ) );
+    if ( !file_name.isEmpty() )
+        start( file_name );
+}
+
+void Tracer::record( const char *name, qint64 start, qint64 end )
+{
+    if ( !_enabled )
+        return;
+    Span span;
+    span.name = name;
+    span.start = start;
+    span.duration = end - start;
+    span.thread = reinterpret_cast<quintptr>( QThread::currentThreadId() );
+    _spans.append( span );
+}
+
+bool Tracer::stop()
+{
+    if ( !_enabled )
+        return true;
+    _enabled = false;
+
+    QFile file( _file_name );
+    if ( !file.open( QFile::WriteOnly | QFile::Text ) )
+        return false;
+
+    QTextStream out( &file );
+    qint64 pid = QCoreApplication::applicationPid();
+    out << "{\"traceEvents\":[\n";
+    for ( int i = 0; i < _spans.count(); i++ )
+    {
+        const Span &span = _spans.at( i );
+        out << ( i == 0 ? "" : ",\n" )
+            << "{\"name\":\"" << span.name << "\",\"cat\":\"oqamldebug\",\"ph\":\"X\""
+            << ",\"ts\":" << QString::number( span.start / 1000.0, 'f', 3 )
+            << ",\"dur\":" << QString::number( span.duration / 1000.0, 'f', 3 )
+            << ",\"pid\":" << pid << ",\"tid\":" << span.thread << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    _spans.clear();
+    return true;
+}
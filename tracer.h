@@ -0,0 +1,51 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+
+// Opt-in recorder of scoped spans, written as Chrome trace events
+// (chrome://tracing, Perfetto).
+// Enabled by Tracer::start(), usually through OQAMLDEBUG_TRACE=<file.json>.
+class Tracer
+{
+public:
+    static void start( const QString &file_name );
+    static void startFromEnvironment();
+    static bool stop();
+    static bool isEnabled() { return _enabled; }
+    static qint64 now() { return _clock.nsecsElapsed(); }
+    static void record( const char *name, qint64 start, qint64 end );
+
+private:
+    struct Span
+    {
+        const char *name;
+        qint64 start;
+        qint64 duration;
+        quintptr thread;
+    };
+    static bool _enabled;
+    static QElapsedTimer _clock;
+    static QString _file_name;
+    static QVector<Span> _spans;
+};
+
+// Records the lifetime of the enclosing block; name must be a string literal
+class TraceScope
+{
+public:
+    TraceScope( const char *name ) : _name( name ), _start( Tracer::isEnabled() ? Tracer::now() : -1 ) { }
+    ~TraceScope() { if ( _start >= 0 ) Tracer::record( _name, _start, Tracer::now() ); }
+
+private:
+    const char *_name;
+    qint64 _start;
+};
+
+#define TRACE_SCOPE_CONCAT2( a, b ) a##b
+#define TRACE_SCOPE_CONCAT( a, b ) TRACE_SCOPE_CONCAT2( a, b )
+#define TRACE_SCOPE( name ) TraceScope TRACE_SCOPE_CONCAT( trace_scope_, __LINE__ )( name )
+
+#endif
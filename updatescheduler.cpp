@@ -0,0 +1,75 @@
+#include "updatescheduler.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QMetaObject>
+
+UpdateScheduler *UpdateScheduler::instance()
+{
+    static UpdateScheduler *scheduler_p = new UpdateScheduler();
+    return scheduler_p;
+}
+
+UpdateScheduler::UpdateScheduler() : QObject( qApp )
+{
+    _frame_interval = 16;
+    QScreen *screen_p = QGuiApplication::primaryScreen();
+    if ( screen_p && screen_p->refreshRate() > 1.0 )
+        _frame_interval = qMax( 1, int( 1000.0 / screen_p->refreshRate() ) );
+    _timer.setSingleShot( true );
+    _timer.setTimerType( Qt::PreciseTimer );
+    connect( &_timer, SIGNAL( timeout() ), this, SLOT( flush() ) );
+}
+
+// Idle: at the next event loop iteration, otherwise one frame after the last flush
+void UpdateScheduler::schedule()
+{
+    if ( _timer.isActive() )
+        return;
+    int delay = 0;
+    if ( _last_flush.isValid() )
+        delay = qMax( qint64( 0 ), _frame_interval - _last_flush.elapsed() );
+    _timer.start( delay );
+}
+
+void UpdateScheduler::update( QWidget *widget_p )
+{
+    if ( !_widgets.contains( widget_p ) )
+        _widgets.append( widget_p );
+    schedule();
+}
+
+void UpdateScheduler::invoke( QObject *receiver_p, const char *method )
+{
+    for ( QList<Call>::const_iterator itCall = _calls.begin(); itCall != _calls.end(); ++itCall )
+    {
+        if ( itCall->receiver == receiver_p && itCall->method == method )
+            return;
+    }
+    Call call;
+    call.receiver = receiver_p;
+    call.method = method;
+    _calls.append( call );
+    schedule();
+}
+
+void UpdateScheduler::flush()
+{
+    _last_flush.start();
+
+    // requests made while flushing are for the next frame
+    QList<Call> calls;
+    calls.swap( _calls );
+    QList< QPointer<QWidget> > widgets;
+    widgets.swap( _widgets );
+
+    for ( QList<Call>::const_iterator itCall = calls.begin(); itCall != calls.end(); ++itCall )
+    {
+        if ( itCall->receiver )
+            QMetaObject::invokeMethod( itCall->receiver, itCall->method.constData() );
+    }
+    for ( QList< QPointer<QWidget> >::const_iterator itWidget = widgets.begin(); itWidget != widgets.end(); ++itWidget )
+    {
+        if ( *itWidget )
+            (*itWidget)->update();
+    }
+}
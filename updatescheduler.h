@@ -0,0 +1,45 @@
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QWidget>
+#include <QList>
+#include <QByteArray>
+
+// Collects the pending repaints and view refreshes of the panes and
+// performs them at most once per display frame.
+// A request is ignored if the same one is already pending.
+class UpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static UpdateScheduler *instance();
+    // Coalesced QWidget::update()
+    void update( QWidget *widget_p );
+    // Coalesced call of the slot method (name without signature) of receiver_p
+    void invoke( QObject *receiver_p, const char *method );
+
+private slots:
+    void flush();
+
+private:
+    UpdateScheduler();
+    void schedule();
+
+    struct Call
+    {
+        QPointer<QObject> receiver;
+        QByteArray method;
+    };
+    QList< QPointer<QWidget> > _widgets;
+    QList<Call> _calls;
+    QTimer _timer;
+    QElapsedTimer _last_flush;
+    int _frame_interval;
+};
+
+#endif
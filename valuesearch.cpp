@@ -0,0 +1,191 @@
+#include "valuesearch.h"
+#include "ocamldebugengine.h"
+#include "debuggerreply.h"
+
+ValueSearch::ValueSearch( OCamlDebugEngine *engine_p ) : QObject( engine_p ),
+    _engine_p( engine_p ),
+    _state( IDLE ),
+    _mode( FIND_CHANGE ),
+    _sequence( 0 ),
+    _print_sequence( 0 ),
+    _low( 0 ),
+    _high( 0 ),
+    _middle( 0 ),
+    _stride( 1 ),
+    _evaluations( 0 )
+{
+    connect( _engine_p, SIGNAL( commandCompleted( const DebuggerCommand & ) ), this, SLOT( commandCompleted( const DebuggerCommand & ) ) );
+    connect( _engine_p, SIGNAL( debuggerStarted( bool ) ), this, SLOT( debuggerStarted( bool ) ) );
+}
+
+void ValueSearch::start( Mode mode, const QString &expression )
+{
+    _mode = mode;
+    _expression = expression.trimmed();
+    _print_command = "print " + _expression;
+    _evaluations = 0;
+    _engine_p->setStopsReported( false );
+    _state = REFERENCE;
+    evaluate( QString() );
+}
+
+void ValueSearch::findChange( const QString &expression, int from_time )
+{
+    if ( isRunning() || !_engine_p->isRunning() || _engine_p->time() <= from_time )
+    {
+        emit finished( expression, false, _engine_p->time() );
+        return;
+    }
+    _low = from_time;
+    _high = _engine_p->time();
+    start( FIND_CHANGE, expression );
+}
+
+void ValueSearch::runUntilChange( const QString &expression )
+{
+    if ( isRunning() || !_engine_p->isRunning() )
+    {
+        emit finished( expression, false, _engine_p->time() );
+        return;
+    }
+    _low = _high = qMax( 0, _engine_p->time() );
+    _stride = 1;
+    start( RUN_UNTIL_CHANGE, expression );
+}
+
+void ValueSearch::cancel()
+{
+    if ( isRunning() )
+        finish( false, _mode == FIND_CHANGE ? _high : _low );
+}
+
+// When finding a change, the value matches if it is the reference (current value);
+// when running until a change, if it differs from the reference (initial value).
+// An expression which cannot be evaluated (out of scope...) never matches.
+bool ValueSearch::matches( const QString &value ) const
+{
+    if ( DebuggerReply::isError( value ) )
+        return false;
+    if ( _mode == FIND_CHANGE )
+        return value == _reference;
+    return value != _reference;
+}
+
+void ValueSearch::step()
+{
+    _state = STEP;
+    _high = _low + _stride;
+    evaluate( _stride > 1 ? "step " + QString::number( _stride ) : QString( "step" ) );
+}
+
+// The commands of the search are internal: the views do not see their answers
+// and a print of the same expression by a watch is not taken for the search's one
+DebuggerCommand ValueSearch::command( const QString &command )
+{
+    DebuggerCommand debugger_command( command, DebuggerCommand::HIDE_ALL_OUTPUT );
+    debugger_command.setSequence( ++_sequence );
+    return debugger_command;
+}
+
+// Moves the execution, then prints the expression; the print is answered
+// in commandCompleted()
+void ValueSearch::evaluate( const QString &move_command )
+{
+    if ( !move_command.isEmpty() )
+        _engine_p->debugger( command( move_command ) );
+    DebuggerCommand print_command = command( _print_command );
+    _print_sequence = print_command.sequence();
+    _engine_p->debugger( print_command );
+    _evaluations++;
+}
+
+void ValueSearch::bisect()
+{
+    if ( _high - _low <= 1 )
+    {
+        finish( true, _high );
+        return;
+    }
+    _state = BISECT;
+    _middle = _low + ( _high - _low ) / 2;
+    evaluate( "goto " + QString::number( _middle ) );
+}
+
+void ValueSearch::commandCompleted( const DebuggerCommand &command )
+{
+    if ( _state == IDLE || command.sequence() != _print_sequence )
+        return;
+
+    QString value = command.result().trimmed();
+    switch ( _state )
+    {
+        case REFERENCE:
+            if ( DebuggerReply::isError( value ) )
+            {
+                finish( false, _mode == FIND_CHANGE ? _high : _low );
+                break;
+            }
+            _reference = value;
+            if ( _mode == RUN_UNTIL_CHANGE )
+                step();
+            else
+            {
+                _state = LOW_BOUND;
+                evaluate( "goto " + QString::number( _low ) );
+            }
+            break;
+        case LOW_BOUND:
+            if ( matches( value ) )
+                finish( false, _high ); // no change in the range
+            else
+                bisect();
+            break;
+        case STEP:
+            if ( _engine_p->time() < _high )
+            {
+                // breakpoint or end of the program reached within the stride
+                _high = _engine_p->time();
+                if ( matches( value ) )
+                    bisect();
+                else
+                    finish( false, _high );
+            }
+            else if ( matches( value ) )
+                bisect();
+            else
+            {
+                _low = _high;
+                if ( _stride < 4096 )
+                    _stride *= 2;
+                step();
+            }
+            break;
+        case BISECT:
+            if ( matches( value ) )
+                _high = _middle;
+            else
+                _low = _middle;
+            bisect();
+            break;
+        case IDLE:
+            break;
+    }
+}
+
+void ValueSearch::finish( bool found, int time )
+{
+    _state = IDLE;
+    _engine_p->setStopsReported( true );
+    if ( _engine_p->isRunning() )
+        _engine_p->debugger( DebuggerCommand( "goto " + QString::number( time ), DebuggerCommand::HIDE_DEBUGGER_OUTPUT ) );
+    emit finished( _expression, found, time );
+}
+
+void ValueSearch::debuggerStarted( bool )
+{
+    if ( isRunning() )
+    {
+        _state = IDLE;
+        _engine_p->setStopsReported( true );
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef VALUESEARCH_H
+#define VALUESEARCH_H
+
+#include <QObject>
+#include <QString>
+#include "debuggercommand.h"
+
+class OCamlDebugEngine;
+
+// Searches the execution time at which the printed value of an expression
+// changes, with counted 'step', 'goto' and hidden 'print' commands.
+// The stops are not reported while searching; the execution finally moves
+// to the time found with a reported stop.
+class ValueSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode
+    {
+        FIND_CHANGE,
+        RUN_UNTIL_CHANGE
+    };
+    ValueSearch( OCamlDebugEngine *engine_p );
+    Mode mode() const { return _mode; }
+    bool isRunning() const { return _state != IDLE; }
+    const QString & expression() const { return _expression; }
+    // Number of prints of the last search
+    int evaluations() const { return _evaluations; }
+
+public slots:
+    // Bisection of [from_time, current time] for the first time at which
+    // the expression has its current value
+    void findChange( const QString &expression, int from_time = 0 );
+    // Software watchpoint: steps forward with a growing stride until the
+    // value differs, then bisects the last stride for the exact time
+    void runUntilChange( const QString &expression );
+    void cancel();
+
+signals:
+    void finished( const QString &expression, bool found, int time );
+
+private slots:
+    void commandCompleted( const DebuggerCommand & );
+    void debuggerStarted( bool );
+
+private:
+    enum State
+    {
+        IDLE,
+        REFERENCE,
+        LOW_BOUND,
+        STEP,
+        BISECT
+    };
+    void start( Mode mode, const QString &expression );
+    bool matches( const QString &value ) const;
+    void step();
+    void evaluate( const QString &move_command );
+    DebuggerCommand command( const QString &command );
+    void bisect();
+    void finish( bool found, int time );
+
+    OCamlDebugEngine *_engine_p;
+    State _state;
+    Mode _mode;
+    QString _expression;
+    QString _print_command;
+    // Sequence number of the last command issued, and of the print awaited
+    int _sequence;
+    int _print_sequence;
+    QString _reference;
+    // Invariant of the bisection: the value at _low does not match or
+    // cannot be evaluated, the value at _high matches (see matches())
+    int _low, _high, _middle;
+    int _stride;
+    int _evaluations;
+};
+
+#endif